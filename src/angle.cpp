@@ -0,0 +1,183 @@
+#include "angle.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ANGLE_MAX_WHOLE ((INT32_MAX - ANGLE_SCALE) / ANGLE_SCALE)
+#define ANGLE_EXACT_DIGITS 15 // Significant digits a double always reproduces
+
+// The former floating point path: String::toDouble() (atof) with ',' replaced
+// by '.', then rounded to two decimals by String(value, 2) ("%.2f").
+static void parseAngleExact(const char *text, angle_t &value)
+{
+    size_t size = strlen(text) + 1;
+    char *copy = (char *)malloc(size);
+    char buffer[ANGLE_STRING_SIZE];
+
+    if (copy == NULL)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        copy[i] = text[i] == ',' ? '.' : text[i];
+    }
+    double number = strtod(copy, NULL);
+    free(copy);
+
+    // Same saturation as parseAngle()
+    if (!(number < ANGLE_MAX_WHOLE + 1.0))
+    {
+        number = ANGLE_MAX_WHOLE;
+    }
+    else if (!(number > -ANGLE_MAX_WHOLE - 1.0))
+    {
+        number = -ANGLE_MAX_WHOLE;
+    }
+
+    // At most "-21474836.00", which still fits in centidegrees
+    snprintf(buffer, sizeof(buffer), "%.2f", number);
+    int32_t result = 0;
+    for (const char *c = buffer + (buffer[0] == '-'); *c != '\0'; c++)
+    {
+        if (*c != '.')
+        {
+            result = result * 10 + (*c - '0');
+        }
+    }
+    value = buffer[0] == '-' ? -result : result;
+}
+
+// Parses a decimal angle like "12", "-0.5" or "123,456" and rounds it to
+// centidegrees. Like String::toDouble() parsing stops at the first invalid
+// character and yields 0 if no digits were found, in which case false is
+// returned. Values beyond +-21474835 degrees saturate there.
+bool parseAngle(const char *text, angle_t &value)
+{
+    const char *start = text;
+    bool negative = false;
+    bool digits = false;
+    bool saturated = false;
+    int32_t whole = 0;
+    int32_t fraction = 0;
+    int fractionDigits = 0;
+    int significant = 0;
+    char roundDigit = '0';
+    bool beyondRoundDigit = false;
+
+    while (*text == ' ' || (*text >= '\t' && *text <= '\r'))
+    {
+        text++;
+    }
+
+    if (*text == '+' || *text == '-')
+    {
+        negative = *text == '-';
+        text++;
+    }
+
+    while (*text >= '0' && *text <= '9')
+    {
+        // Saturate instead of overflowing, no valid angle comes close. The
+        // limit leaves room for the fraction and the rounding below.
+        int digit = *text - '0';
+        if (whole <= (ANGLE_MAX_WHOLE - digit) / 10)
+        {
+            whole = whole * 10 + digit;
+        }
+        else
+        {
+            saturated = true;
+        }
+        significant += significant > 0 || digit != 0;
+        digits = true;
+        text++;
+    }
+
+    // Clients with a German locale send a decimal comma
+    if (*text == '.' || *text == ',')
+    {
+        text++;
+        while (*text >= '0' && *text <= '9')
+        {
+            if (fractionDigits < 2)
+            {
+                fraction = fraction * 10 + (*text - '0');
+            }
+            else if (fractionDigits == 2)
+            {
+                roundDigit = *text;
+            }
+            else if (*text != '0')
+            {
+                beyondRoundDigit = true;
+            }
+            significant += significant > 0 || *text != '0';
+            fractionDigits++;
+            digits = true;
+            text++;
+        }
+    }
+
+    for (int i = fractionDigits; i < 2; i++)
+    {
+        fraction *= 10;
+    }
+
+    if (saturated)
+    {
+        whole = ANGLE_MAX_WHOLE;
+        fraction = 0;
+        roundDigit = '0';
+    }
+
+    int32_t result = whole * ANGLE_SCALE + fraction + (roundDigit >= '5' ? 1 : 0);
+    value = digits ? (negative ? -result : result) : 0;
+
+    // The old path rounded the nearest double, which lies on either side of
+    // a decimal tie like "359.995", and atof() also took exponents and hex.
+    // These rare inputs go through it so the protocol stays identical.
+    bool tie = roundDigit == '5' && !beyondRoundDigit;
+    bool exponent = *text == 'e' || *text == 'E' || *text == 'x' || *text == 'X';
+    if (digits && (exponent || (!saturated && (tie || significant > ANGLE_EXACT_DIGITS))))
+    {
+        parseAngleExact(start, value);
+    }
+    return digits;
+}
+
+// Writes the angle with two decimals like String(value, 2) did and returns
+// the length without the terminating zero.
+size_t formatAngle(angle_t value, char *buffer)
+{
+    char digits[10];
+    size_t length = 0;
+    int count = 0;
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t whole = magnitude / ANGLE_SCALE;
+    uint32_t fraction = magnitude % ANGLE_SCALE;
+
+    if (value < 0)
+    {
+        buffer[length++] = '-';
+    }
+
+    do
+    {
+        digits[count++] = '0' + whole % 10;
+        whole /= 10;
+    } while (whole != 0);
+
+    while (count > 0)
+    {
+        buffer[length++] = digits[--count];
+    }
+
+    buffer[length++] = '.';
+    buffer[length++] = '0' + fraction / 10;
+    buffer[length++] = '0' + fraction % 10;
+    buffer[length] = '\0';
+
+    return length;
+}
@@ -0,0 +1,21 @@
+#ifndef ANGLE_H
+#define ANGLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Angles are kept in centidegrees. The ESP32-C3 has no FPU, so the control
+// path and the rotctl protocol only use integer arithmetic. Two decimals is
+// also what the protocol and the EEPROM layout already use.
+typedef int32_t angle_t;
+
+#define ANGLE_SCALE 100
+#define ANGLE_DEGREES(degrees) ((angle_t)(degrees) * ANGLE_SCALE)
+
+// Large enough for "-21474836.48" and the terminating zero
+#define ANGLE_STRING_SIZE 16
+
+bool parseAngle(const char *text, angle_t &value);
+size_t formatAngle(angle_t value, char *buffer);
+
+#endif
@@ -0,0 +1,111 @@
+#ifdef ROTOR_BENCHMARK
+
+#include "benchmark.h"
+#include <Arduino.h>
+#include "angle.h"
+
+#define BENCHMARK_ITERATIONS 1000
+
+static volatile int sink;
+
+// Decision made by Rotor::updatePosition() before the switch to centidegrees
+static int legacyControlStep(double target, double current, int tolerance)
+{
+    if (fabs(target - current) <= tolerance)
+    {
+        return 0;
+    }
+    return target > current ? 1 : -1;
+}
+
+static int fixedControlStep(angle_t target, angle_t current, int tolerance)
+{
+    if (abs(target - current) <= (angle_t)tolerance * ANGLE_SCALE)
+    {
+        return 0;
+    }
+    return target > current ? 1 : -1;
+}
+
+// "P az el" argument parsing and "p" reply formatting as processCommand() did it
+static int legacyCommand(const String &azimuth, const String &elevation)
+{
+    String az = azimuth;
+    String el = elevation;
+    az.replace(',', '.');
+    el.replace(',', '.');
+    double target = az.toDouble() + el.toDouble();
+    String reply = String(target, 2) + "\n" + String(target, 2) + "\nRPRT 0\n";
+    return reply.length();
+}
+
+static int fixedCommand(const String &azimuth, const String &elevation)
+{
+    angle_t az;
+    angle_t el;
+    char reply[2 * ANGLE_STRING_SIZE + 8];
+    parseAngle(azimuth.c_str(), az);
+    parseAngle(elevation.c_str(), el);
+    size_t length = formatAngle(az + el, reply);
+    reply[length++] = '\n';
+    length += formatAngle(az + el, reply + length);
+    strcpy(reply + length, "\nRPRT 0\n");
+    return length + 8;
+}
+
+static void report(const char *name, uint32_t legacyCycles, uint32_t fixedCycles)
+{
+    Serial.printf("| %-23s | %12u | %12u |\n", name,
+                  legacyCycles / BENCHMARK_ITERATIONS, fixedCycles / BENCHMARK_ITERATIONS);
+}
+
+void runBenchmarks()
+{
+    volatile double legacyTarget = 123.45;
+    volatile double legacyCurrent = 98.76;
+    volatile angle_t fixedTarget = 12345;
+    volatile angle_t fixedCurrent = 9876;
+    String azimuth = "123.45";
+    String elevation = "67,89";
+    uint32_t start;
+    uint32_t legacyCycles;
+    uint32_t fixedCycles;
+
+    Serial.println("+-------------------------+--------------+--------------+");
+    Serial.println("|  Cycles per call        |       double |  centidegree |");
+    Serial.println("+-------------------------+--------------+--------------+");
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        sink = legacyControlStep(legacyTarget, legacyCurrent, 2);
+    }
+    legacyCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        sink = fixedControlStep(fixedTarget, fixedCurrent, 2);
+    }
+    fixedCycles = ESP.getCycleCount() - start;
+    report("Control step", legacyCycles, fixedCycles);
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        sink = legacyCommand(azimuth, elevation);
+    }
+    legacyCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        sink = fixedCommand(azimuth, elevation);
+    }
+    fixedCycles = ESP.getCycleCount() - start;
+    report("Parse P, format p", legacyCycles, fixedCycles);
+
+    Serial.println("+-------------------------+--------------+--------------+");
+}
+
+#endif
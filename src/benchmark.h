@@ -0,0 +1,8 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Compares the former double based control path with the fixed-point one.
+// Only built with -DROTOR_BENCHMARK, results are printed to Serial.
+void runBenchmarks();
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <driver/gpio.h>
+#include <soc/soc_caps.h>
+
+// Pins of one axis: motor outputs for both directions and the poti input
+struct AxisPins
+{
+    gpio_num_t left;
+    gpio_num_t right;
+    gpio_num_t poti;
+};
+
+// A board is described by a header in src/boards/ which defines BOARD_NAME,
+// BOARD_AZIMUTH_PINS and BOARD_ELEVATION_PINS as constexpr AxisPins. Boards
+// not listed here can be selected with -DBOARD_HEADER='"boards/<name>.h"'.
+#if defined(BOARD_HEADER)
+#include BOARD_HEADER
+#elif defined(ESP32_C3_DEVKITM_1)
+#include "boards/esp32_c3_devkitm_1.h"
+#elif defined(ESP32_C3_SUPERMINI)
+#include "boards/esp32_c3_supermini.h"
+#else
+#error "No board selected, define ESP32_C3_DEVKITM_1, ESP32_C3_SUPERMINI or BOARD_HEADER"
+#endif
+
+#ifndef BOARD_USES_USB_SERIAL
+#define BOARD_USES_USB_SERIAL 0
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32C3
+// ADC2 can not be read while Wi-Fi is active, so the potis need ADC1 (GPIO0-4)
+#define BOARD_ADC_GPIO_MASK 0x0000001FUL
+// USB D-/D+ of the USB Serial/JTAG controller
+#define BOARD_USB_GPIO_MASK ((1UL << GPIO_NUM_18) | (1UL << GPIO_NUM_19))
+// Strapping pins, sampled at reset. GPIO2 and GPIO8 must read high to boot
+// from flash, a poti wiper or motor driver input could hold them low.
+#define BOARD_STRAPPING_GPIO_MASK ((1UL << GPIO_NUM_2) | (1UL << GPIO_NUM_8) | (1UL << GPIO_NUM_9))
+#else
+#error "Pin checks are only defined for the ESP32-C3"
+#endif
+
+constexpr bool isValidOutputPin(gpio_num_t pin)
+{
+    return pin >= 0 && pin < 32 && ((SOC_GPIO_VALID_OUTPUT_GPIO_MASK >> pin) & 1);
+}
+
+constexpr bool isValidPotiPin(gpio_num_t pin)
+{
+    return pin >= 0 && pin < 32 && ((BOARD_ADC_GPIO_MASK >> pin) & 1);
+}
+
+constexpr bool isUsbPin(gpio_num_t pin)
+{
+    return pin >= 0 && pin < 32 && ((BOARD_USB_GPIO_MASK >> pin) & 1);
+}
+
+constexpr bool isStrappingPin(gpio_num_t pin)
+{
+    return pin >= 0 && pin < 32 && ((BOARD_STRAPPING_GPIO_MASK >> pin) & 1);
+}
+
+constexpr bool sharesPin(const AxisPins &a, gpio_num_t pin)
+{
+    return a.left == pin || a.right == pin || a.poti == pin;
+}
+
+constexpr bool hasPinConflict(const AxisPins &a)
+{
+    return a.left == a.right || a.left == a.poti || a.right == a.poti;
+}
+
+constexpr bool hasPinConflict(const AxisPins &a, const AxisPins &b)
+{
+    return sharesPin(a, b.left) || sharesPin(a, b.right) || sharesPin(a, b.poti);
+}
+
+static_assert(!hasPinConflict(BOARD_AZIMUTH_PINS), "Azimuth pins of " BOARD_NAME " must be distinct");
+static_assert(!hasPinConflict(BOARD_ELEVATION_PINS), "Elevation pins of " BOARD_NAME " must be distinct");
+static_assert(!hasPinConflict(BOARD_AZIMUTH_PINS, BOARD_ELEVATION_PINS), "Azimuth and elevation of " BOARD_NAME " share a pin");
+
+#endif
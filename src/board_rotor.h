@@ -0,0 +1,71 @@
+#ifndef BOARD_ROTOR_H
+#define BOARD_ROTOR_H
+
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+#include "rotor.h"
+#include "board.h"
+
+// Rotor bound to fixed pins at compile time. Motor outputs are switched
+// through the GPIO set/clear registers, which need no read-modify-write and
+// leave the other pins alone. A direction change is still two writes: the
+// opposite output is cleared before the new one is set. An interrupt in
+// between only leaves both outputs off for a moment, the motor is never
+// driven in both directions at once.
+template <gpio_num_t PinLeft, gpio_num_t PinRight, gpio_num_t PinPoti>
+class BoardRotor : public Rotor
+{
+    static_assert(isValidOutputPin(PinLeft), "Left motor pin is not a valid output");
+    static_assert(isValidOutputPin(PinRight), "Right motor pin is not a valid output");
+    static_assert(isValidPotiPin(PinPoti), "Poti pin has no ADC1 channel");
+    static_assert(PinLeft != PinRight && PinLeft != PinPoti && PinRight != PinPoti, "Rotor pins must be distinct");
+    static_assert(!BOARD_USES_USB_SERIAL || !(isUsbPin(PinLeft) || isUsbPin(PinRight) || isUsbPin(PinPoti)),
+                  "Rotor pin collides with the USB serial port");
+    static_assert(!isStrappingPin(PinLeft) && !isStrappingPin(PinRight) && !isStrappingPin(PinPoti),
+                  "Rotor pin is a strapping pin and could prevent booting");
+
+    static constexpr uint32_t maskLeft = 1UL << PinLeft;
+    static constexpr uint32_t maskRight = 1UL << PinRight;
+
+public:
+    BoardRotor(angle_t home, int homeAddr, angle_t min, int minAddr, angle_t max, int maxAddr, int potiTolerance, int numReadings)
+        : Rotor(home, homeAddr, min, minAddr, max, maxAddr, potiTolerance, numReadings)
+    {
+    }
+
+    void moveLeft() override
+    {
+        // Release the opposite direction first so both outputs are never high
+        REG_WRITE(GPIO_OUT_W1TC_REG, maskRight);
+        REG_WRITE(GPIO_OUT_W1TS_REG, maskLeft);
+    }
+
+    void moveRight() override
+    {
+        REG_WRITE(GPIO_OUT_W1TC_REG, maskLeft);
+        REG_WRITE(GPIO_OUT_W1TS_REG, maskRight);
+    }
+
+    void stop() override
+    {
+        REG_WRITE(GPIO_OUT_W1TC_REG, maskLeft | maskRight);
+    }
+
+protected:
+    void setupPins() override
+    {
+        pinMode(PinRight, OUTPUT);
+        pinMode(PinLeft, OUTPUT);
+        pinMode(PinPoti, INPUT);
+    }
+
+    int readPoti() override
+    {
+        return analogRead(PinPoti);
+    }
+};
+
+typedef BoardRotor<BOARD_AZIMUTH_PINS.left, BOARD_AZIMUTH_PINS.right, BOARD_AZIMUTH_PINS.poti> AzimuthRotor;
+typedef BoardRotor<BOARD_ELEVATION_PINS.left, BOARD_ELEVATION_PINS.right, BOARD_ELEVATION_PINS.poti> ElevationRotor;
+
+#endif
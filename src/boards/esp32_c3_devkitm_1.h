@@ -0,0 +1,9 @@
+#ifndef BOARD_ESP32_C3_DEVKITM_1_H
+#define BOARD_ESP32_C3_DEVKITM_1_H
+
+#define BOARD_NAME "ESP32-C3-DevKitM-1"
+
+constexpr AxisPins BOARD_AZIMUTH_PINS = {GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_0};
+constexpr AxisPins BOARD_ELEVATION_PINS = {GPIO_NUM_5, GPIO_NUM_4, GPIO_NUM_3};
+
+#endif
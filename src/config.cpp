@@ -0,0 +1,81 @@
+#include "config.h"
+#include <atomic>
+
+static ConfigSnapshot activeConfig = std::make_shared<const Config>();
+
+ConfigSnapshot getConfig()
+{
+    return std::atomic_load(&activeConfig);
+}
+
+ConfigSnapshot swapConfig(const Config &next)
+{
+    return std::atomic_exchange(&activeConfig, std::make_shared<const Config>(next));
+}
+
+static bool sanitizeAngle(angle_t &value)
+{
+    if (value < ANGLE_DEGREES(-360) || value > ANGLE_DEGREES(360))
+    {
+        value = 0;
+        return true;
+    }
+    return false;
+}
+
+// Replaces out of range values with their defaults, returns true if anything was changed
+bool sanitizeConfig(Config &config)
+{
+    bool changed = false;
+
+    if (config.tcpServerPort < 1 || config.tcpServerPort > 65535)
+    {
+        config.tcpServerPort = DEFAULT_TCP_SERVER_PORT;
+        changed = true;
+    }
+
+    if (config.webServerPort < 1 || config.webServerPort > 65535)
+    {
+        config.webServerPort = DEFAULT_WEBSERVER_PORT;
+        changed = true;
+    }
+
+    if (config.positionUpdateInterval < 1)
+    {
+        config.positionUpdateInterval = DEFAULT_POSITION_UPDATE_INTERVAL;
+        changed = true;
+    }
+
+    if (config.potiTolerance < 0)
+    {
+        config.potiTolerance = DEFAULT_POTI_TOLERANCE;
+        changed = true;
+    }
+
+    if (config.numReadings < 1 || config.numReadings > MAX_NUM_READINGS)
+    {
+        config.numReadings = DEFAULT_NUM_READINGS;
+        changed = true;
+    }
+
+    if (config.serialMode < 0 || config.serialMode > MAX_SERIAL_MODE)
+    {
+        config.serialMode = DEFAULT_SERIAL_MODE;
+        changed = true;
+    }
+
+    if (config.feedForward < 0 || config.feedForward > 1)
+    {
+        config.feedForward = DEFAULT_FEED_FORWARD;
+        changed = true;
+    }
+
+    changed |= sanitizeAngle(config.azimuthHome);
+    changed |= sanitizeAngle(config.azimuthMin);
+    changed |= sanitizeAngle(config.azimuthMax);
+    changed |= sanitizeAngle(config.elevationHome);
+    changed |= sanitizeAngle(config.elevationMin);
+    changed |= sanitizeAngle(config.elevationMax);
+
+    return changed;
+}
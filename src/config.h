@@ -0,0 +1,44 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <memory>
+#include "angle.h"
+
+// Define default values
+#define DEFAULT_TCP_SERVER_PORT 4533
+#define DEFAULT_WEBSERVER_PORT 80
+#define DEFAULT_POSITION_UPDATE_INTERVAL 10
+#define DEFAULT_POTI_TOLERANCE 2
+#define DEFAULT_NUM_READINGS 64
+#define MAX_NUM_READINGS 1024
+#define DEFAULT_SERIAL_MODE 0 // SERIAL_MODE_DEBUG
+#define MAX_SERIAL_MODE 2
+#define DEFAULT_FEED_FORWARD 1
+
+struct Config
+{
+    int tcpServerPort = DEFAULT_TCP_SERVER_PORT;
+    int webServerPort = DEFAULT_WEBSERVER_PORT;
+    int positionUpdateInterval = DEFAULT_POSITION_UPDATE_INTERVAL;
+    int potiTolerance = DEFAULT_POTI_TOLERANCE;
+    int numReadings = DEFAULT_NUM_READINGS;
+    int serialMode = DEFAULT_SERIAL_MODE;
+    int feedForward = DEFAULT_FEED_FORWARD;
+    angle_t azimuthHome = 0;
+    angle_t azimuthMin = 0;
+    angle_t azimuthMax = 0;
+    angle_t elevationHome = 0;
+    angle_t elevationMin = 0;
+    angle_t elevationMax = 0;
+};
+
+// A published configuration is never modified. Changes are made on a copy
+// which then replaces the active snapshot as a whole, so readers always see
+// a consistent set of values.
+typedef std::shared_ptr<const Config> ConfigSnapshot;
+
+ConfigSnapshot getConfig();
+ConfigSnapshot swapConfig(const Config &next);
+bool sanitizeConfig(Config &config);
+
+#endif
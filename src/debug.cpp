@@ -0,0 +1,29 @@
+#include "debug.h"
+
+class NullPrint : public Print
+{
+public:
+    size_t write(uint8_t) override
+    {
+        return 1;
+    }
+
+    size_t write(const uint8_t *, size_t size) override
+    {
+        return size;
+    }
+};
+
+static NullPrint nullOutput;
+static Print *output = &Serial;
+
+Print &debugOutput()
+{
+    return *output;
+}
+
+// nullptr discards all debug messages
+void setDebugOutput(Print *next)
+{
+    output = next != nullptr ? next : &nullOutput;
+}
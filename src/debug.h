@@ -0,0 +1,11 @@
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <Arduino.h>
+
+// Debug messages go through debugOutput() instead of Serial, so they can be
+// moved off the serial port while it carries rotctl traffic.
+Print &debugOutput();
+void setDebugOutput(Print *output);
+
+#endif
@@ -0,0 +1,279 @@
+#include "log.h"
+#include <atomic>
+#include <mutex>
+#include "angle.h"
+#include "debug.h"
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define LOG_DRAIN_INTERVAL 10 // ms
+
+// Bounded multi-producer, single-consumer ring after Dmitry Vyukov's queue.
+// Each slot carries a sequence number telling producers and the consumer
+// whose turn it is, so neither side ever takes a lock. A full ring drops
+// the record. Sequences are stored relative to the slot index so the zero
+// initialized ring is ready without a constructor.
+struct LogSlot
+{
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+static LogSlot ring[LOG_RING_SIZE];
+static std::atomic<uint32_t> enqueuePos(0);
+static uint32_t dequeuePos = 0;
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<uint8_t> runtimeLevel(LOG_COMPILE_LEVEL);
+
+// Only touched by the drain task and the /api/log handler
+static std::mutex tailMutex;
+static char tail[LOG_TAIL_SIZE];
+static size_t tailStart = 0;
+static size_t tailLength = 0;
+
+static const char levelNames[] = {'D', 'I', 'W', 'E'};
+
+static uint32_t loadSequence(uint32_t pos)
+{
+    uint32_t index = pos & (LOG_RING_SIZE - 1);
+    return ring[index].sequence.load(std::memory_order_acquire) + index;
+}
+
+static void storeSequence(uint32_t pos, uint32_t sequence)
+{
+    uint32_t index = pos & (LOG_RING_SIZE - 1);
+    ring[index].sequence.store(sequence - index, std::memory_order_release);
+}
+
+void logSetLevel(uint8_t level)
+{
+    runtimeLevel = level;
+}
+
+uint8_t logGetLevel()
+{
+    return runtimeLevel;
+}
+
+bool logEnabled(uint8_t level)
+{
+    return level >= runtimeLevel && level < LOG_LEVEL_NONE;
+}
+
+bool logPush(const LogRecord &record)
+{
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        int32_t diff = (int32_t)(loadSequence(pos) - pos);
+
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                ring[pos & (LOG_RING_SIZE - 1)].record = record;
+                storeSequence(pos, pos + 1);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            dropped++;
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static bool logPop(LogRecord &record)
+{
+    if ((int32_t)(loadSequence(dequeuePos) - (dequeuePos + 1)) < 0)
+    {
+        return false;
+    }
+
+    record = ring[dequeuePos & (LOG_RING_SIZE - 1)].record;
+    storeSequence(dequeuePos, dequeuePos + LOG_RING_SIZE);
+    dequeuePos++;
+    return true;
+}
+
+static size_t appendText(char *buffer, size_t length, size_t size, const char *text, int width, bool leftAlign)
+{
+    int textLength = strlen(text);
+    int padding = width > textLength ? width - textLength : 0;
+
+    if (!leftAlign)
+    {
+        while (padding-- > 0 && length < size)
+        {
+            buffer[length++] = ' ';
+        }
+    }
+    while (*text != '\0' && length < size)
+    {
+        buffer[length++] = *text++;
+    }
+    while (padding-- > 0 && length < size)
+    {
+        buffer[length++] = ' ';
+    }
+
+    return length;
+}
+
+// printf subset for log records, see LogRecord
+static size_t formatRecord(const LogRecord &record, char *buffer, size_t size)
+{
+    const char *format = record.format;
+    size_t length = 0;
+    int argIndex = 0;
+
+    // Leave room for the newline and terminating zero
+    size -= 2;
+
+    while (*format != '\0' && length < size)
+    {
+        if (*format != '%')
+        {
+            buffer[length++] = *format++;
+            continue;
+        }
+
+        format++;
+        bool leftAlign = *format == '-';
+        if (leftAlign)
+        {
+            format++;
+        }
+        int width = 0;
+        while (*format >= '0' && *format <= '9')
+        {
+            width = width * 10 + (*format++ - '0');
+        }
+
+        char conversion = *format != '\0' ? *format++ : '%';
+        char value[ANGLE_STRING_SIZE];
+        int32_t arg = conversion != 's' && conversion != '%' && argIndex < record.argCount ? record.args[argIndex++] : 0;
+
+        switch (conversion)
+        {
+        case 'd':
+            snprintf(value, sizeof(value), "%ld", (long)arg);
+            break;
+        case 'u':
+            snprintf(value, sizeof(value), "%lu", (unsigned long)(uint32_t)arg);
+            break;
+        case 'x':
+            snprintf(value, sizeof(value), "%lx", (unsigned long)(uint32_t)arg);
+            break;
+        case 'c':
+            value[0] = (char)arg;
+            value[1] = '\0';
+            break;
+        case 'a':
+            formatAngle(arg, value);
+            break;
+        case 's':
+            length = appendText(buffer, length, size, record.text, width, leftAlign);
+            continue;
+        default:
+            value[0] = conversion;
+            value[1] = '\0';
+            break;
+        }
+
+        length = appendText(buffer, length, size, value, width, leftAlign);
+    }
+
+    buffer[length++] = '\n';
+    buffer[length] = '\0';
+    return length;
+}
+
+static void appendTail(const char *text, size_t length)
+{
+    std::lock_guard<std::mutex> lock(tailMutex);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        tail[(tailStart + tailLength) % LOG_TAIL_SIZE] = text[i];
+        if (tailLength < LOG_TAIL_SIZE)
+        {
+            tailLength++;
+        }
+        else
+        {
+            tailStart = (tailStart + 1) % LOG_TAIL_SIZE;
+        }
+    }
+}
+
+// Formats and writes all pending records, returns how many were written
+size_t logDrain()
+{
+    LogRecord record;
+    char line[160];
+    size_t count = 0;
+
+    while (logPop(record))
+    {
+        int prefix = snprintf(line, sizeof(line), "%lu %c ", (unsigned long)record.timestamp,
+                              levelNames[record.level < sizeof(levelNames) ? record.level : 0]);
+        size_t length = prefix + formatRecord(record, line + prefix, sizeof(line) - prefix);
+
+        debugOutput().write((const uint8_t *)line, length);
+        appendTail(line, length);
+        count++;
+    }
+
+    return count;
+}
+
+#ifdef ESP_PLATFORM
+// Runs below the Arduino loop task, so it only gets the CPU while the loop
+// blocks, e.g. in the 1 ms delay of WebServer::handleClient() without a
+// client or between control ticks in idle mode.
+static void logTask(void *)
+{
+    for (;;)
+    {
+        logDrain();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL));
+    }
+}
+#endif
+
+void logBegin()
+{
+#ifdef ESP_PLATFORM
+    xTaskCreate(logTask, "log", 4096, nullptr, tskIDLE_PRIORITY, nullptr);
+#endif
+}
+
+uint32_t logDropped()
+{
+    return dropped;
+}
+
+// Last LOG_TAIL_SIZE bytes of formatted log output
+String logTail()
+{
+    std::lock_guard<std::mutex> lock(tailMutex);
+    String text;
+
+    text.reserve(tailLength);
+    for (size_t i = 0; i < tailLength; i++)
+    {
+        text += tail[(tailStart + i) % LOG_TAIL_SIZE];
+    }
+
+    return text;
+}
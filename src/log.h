@@ -0,0 +1,112 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+// Records below this level are removed at compile time
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_SIZE 64 // Records, power of two
+#define LOG_MAX_ARGS 4
+#define LOG_TEXT_SIZE 24
+#define LOG_TAIL_SIZE 2048 // Bytes of formatted output kept for /api/log
+
+// A log record stores the format string pointer and the raw arguments.
+// Formatting happens later in the drain task, so logging only copies a few
+// words into the ring and never waits for the UART. Integer arguments go
+// to args, one string argument is copied to text. Besides the usual
+// %d %u %x %c %s the format may use %a for an angle_t in centidegrees.
+struct LogRecord
+{
+    uint32_t timestamp;
+    const char *format;
+    uint8_t level;
+    uint8_t argCount;
+    int32_t args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_SIZE];
+};
+
+void logBegin();
+void logSetLevel(uint8_t level);
+uint8_t logGetLevel();
+bool logEnabled(uint8_t level);
+bool logPush(const LogRecord &record);
+size_t logDrain();
+uint32_t logDropped();
+String logTail();
+
+inline void logSetArg(LogRecord &record, const char *text)
+{
+    strncpy(record.text, text, LOG_TEXT_SIZE - 1);
+    record.text[LOG_TEXT_SIZE - 1] = '\0';
+}
+
+inline void logSetArg(LogRecord &record, const String &text)
+{
+    logSetArg(record, text.c_str());
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type logSetArg(LogRecord &record, T value)
+{
+    if (record.argCount < LOG_MAX_ARGS)
+    {
+        record.args[record.argCount++] = (int32_t)value;
+    }
+}
+
+inline void logSetArgs(LogRecord &)
+{
+}
+
+template <typename T, typename... Rest>
+inline void logSetArgs(LogRecord &record, const T &first, const Rest &...rest)
+{
+    logSetArg(record, first);
+    logSetArgs(record, rest...);
+}
+
+template <typename... Args>
+inline void logWrite(uint8_t level, const char *format, const Args &...args)
+{
+    if (!logEnabled(level))
+    {
+        return;
+    }
+
+    LogRecord record;
+    record.timestamp = millis();
+    record.format = format;
+    record.level = level;
+    record.argCount = 0;
+    record.text[0] = '\0';
+    logSetArgs(record, args...);
+    logPush(record);
+}
+
+#define LOG_AT(level, ...)                  \
+    do                                      \
+    {                                       \
+        if (LOG_COMPILE_LEVEL <= (level))   \
+        {                                   \
+            logWrite((level), __VA_ARGS__); \
+        }                                   \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif
@@ -1,95 +1,87 @@
 #include <WiFi.h>
 #include <WiFiManager.h>
-#include <vector>
 #include <WebServer.h>
 #include <EEPROM.h>
 #include <SPIFFS.h>
-#include "Rotor.h"
-
-#ifdef ESP32_C3_DEVKITM_1
-#define AZIMUTH_PIN_LEFT GPIO_NUM_0
-#define AZIMUTH_PIN_RIGHT GPIO_NUM_1
-#define AZIMUTH_PIN_POTI GPIO_NUM_2
-#define ELEVATION_PIN_LEFT GPIO_NUM_3
-#define ELEVATION_PIN_RIGHT GPIO_NUM_4
-#define ELEVATION_PIN_POTI GPIO_NUM_5
-#endif
-
-#ifdef ESP32_C3_SUPERMINI
-#define AZIMUTH_PIN_LEFT GPIO_NUM_0
-#define AZIMUTH_PIN_RIGHT GPIO_NUM_1
-#define AZIMUTH_PIN_POTI GPIO_NUM_2
-#define ELEVATION_PIN_LEFT GPIO_NUM_3
-#define ELEVATION_PIN_RIGHT GPIO_NUM_4
-#define ELEVATION_PIN_POTI GPIO_NUM_5
-#endif
+#include "board_rotor.h"
+#include "power.h"
+#include "config.h"
+#include "angle.h"
+#include "benchmark.h"
+#include "rotctl.h"
+#include "debug.h"
+#include "log.h"
+#include "telemetry.h"
+#include "tracker.h"
 
 WiFiManager wifiManager;
 
-// Define default values
-#define DEFAULT_TCP_SERVER_PORT 4533
-#define DEFAULT_WEBSERVER_PORT 80
-#define DEFAULT_POSITION_UPDATE_INTERVAL 10
-#define DEFAULT_POTI_TOLERANCE 2
-#define DEFAULT_NUM_READINGS 64
-
 // EEPROM addresses for storing configuration
 #define TCP_SERVER_PORT_ADDR 0          // 2 Bytes (uint16_t)
 #define POSITION_UPDATE_INTERVAL_ADDR 2 // 2 Bytes (uint16_t)
-#define AZIMUTH_HOME_ADDR 4             // 4 Bytes (double -> uint32_t)
-#define AZIMUTH_MIN_ADDR 8              // 4 Bytes (double -> uint32_t)
-#define AZIMUTH_MAX_ADDR 12             // 4 Bytes (double -> uint32_t)
-#define ELEVATION_HOME_ADDR 16          // 4 Bytes (double -> uint32_t)
-#define ELEVATION_MIN_ADDR 20           // 4 Bytes (double -> uint32_t)
-#define ELEVATION_MAX_ADDR 24           // 4 Bytes (double -> uint32_t)
+#define AZIMUTH_HOME_ADDR 4             // 4 Bytes (angle_t -> uint32_t)
+#define AZIMUTH_MIN_ADDR 8              // 4 Bytes (angle_t -> uint32_t)
+#define AZIMUTH_MAX_ADDR 12             // 4 Bytes (angle_t -> uint32_t)
+#define ELEVATION_HOME_ADDR 16          // 4 Bytes (angle_t -> uint32_t)
+#define ELEVATION_MIN_ADDR 20           // 4 Bytes (angle_t -> uint32_t)
+#define ELEVATION_MAX_ADDR 24           // 4 Bytes (angle_t -> uint32_t)
 #define POTI_TOLERANCE_ADDR 28          // 2 Bytes (uint16_t)
 #define NUM_READINGS_ADDR 30            // 2 Bytes (uint16_t)
 #define WEBSERVER_PORT_ADDR 32          // 2 Bytes (uint16_t)
+#define SERIAL_MODE_ADDR 34             // 2 Bytes (uint16_t)
+#define FEED_FORWARD_ADDR 36            // 2 Bytes (uint16_t)
 
-// Variables to store configuration
-int tcpServerPort = DEFAULT_TCP_SERVER_PORT;
-int webServerPort = DEFAULT_WEBSERVER_PORT;
-int positionUpdateInterval = DEFAULT_POSITION_UPDATE_INTERVAL;
-int potiTolerance = DEFAULT_POTI_TOLERANCE;
-int numReadings = DEFAULT_NUM_READINGS;
+AzimuthRotor rotorAzimuth(0, AZIMUTH_HOME_ADDR, 0, AZIMUTH_MIN_ADDR, 0, AZIMUTH_MAX_ADDR, DEFAULT_POTI_TOLERANCE, DEFAULT_NUM_READINGS);
+ElevationRotor rotorElevation(0, ELEVATION_HOME_ADDR, 0, ELEVATION_MIN_ADDR, 0, ELEVATION_MAX_ADDR, DEFAULT_POTI_TOLERANCE, DEFAULT_NUM_READINGS);
 
-Rotor rotorAzimuth(0.00, AZIMUTH_HOME_ADDR, 0.00, AZIMUTH_MIN_ADDR, 0.00, AZIMUTH_MAX_ADDR, GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_2, potiTolerance, numReadings);
-Rotor rotorElevation(0.00, ELEVATION_HOME_ADDR, 0.00, ELEVATION_MIN_ADDR, 0.00, ELEVATION_MAX_ADDR, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_2, potiTolerance, numReadings);
-
-WiFiServer server(tcpServerPort);
-WebServer webServer(webServerPort);
+WiFiServer server(DEFAULT_TCP_SERVER_PORT);
+WebServer webServer(DEFAULT_WEBSERVER_PORT);
 
+bool serversStarted = false;
+bool webServerRebindPending = false;
 unsigned long lastPositionUpdate = 0;
-std::vector<WiFiClient> clients;
 
-void saveConfig();
+SetpointTracker azimuthTracker;
+SetpointTracker elevationTracker;
+unsigned long lastControlTickMicros = 0;
+unsigned long controlTickMicros = DEFAULT_POSITION_UPDATE_INTERVAL * 1000UL;
+
+void saveConfig(const Config &config);
 
-void splitString(const String &input, std::vector<String> &output)
+static String angleToString(angle_t value)
 {
-    int start = 0;
-    int end;
-    while ((end = input.indexOf(' ', start)) != -1)
-    {
-        output.push_back(input.substring(start, end));
-        start = end + 1;
-    }
-    output.push_back(input.substring(start));
+    char buffer[ANGLE_STRING_SIZE];
+    formatAngle(value, buffer);
+    return String(buffer);
 }
 
-static String getRotorCurrentPosition()
+static angle_t stringToAngle(const String &text)
 {
-    return String(rotorAzimuth.getCurrent(), 2) + "\n" + String(rotorElevation.getCurrent(), 2) + "\nRPRT 0\n";
+    angle_t value;
+    parseAngle(text.c_str(), value);
+    return value;
 }
 
-static String setRotorPosition(double azimuth, double elevation)
+String setRotorPosition(angle_t azimuth, angle_t elevation)
 {
+    powerWake();
+    azimuthTracker.addSetpoint(azimuth, millis());
+    elevationTracker.addSetpoint(elevation, millis());
     rotorAzimuth.setTarget(azimuth);
     rotorElevation.setTarget(elevation);
     return "RPRT 0\n";
 }
 
-static String stopRotor()
+void getRotorTarget(angle_t &azimuth, angle_t &elevation)
+{
+    azimuth = rotorAzimuth.getTarget();
+    elevation = rotorElevation.getTarget();
+}
+
+String stopRotor()
 {
+    azimuthTracker.reset();
+    elevationTracker.reset();
     rotorAzimuth.setTarget(rotorAzimuth.getCurrent());
     rotorElevation.setTarget(rotorElevation.getCurrent());
     return "RPRT 0\n";
@@ -109,103 +101,58 @@ static String resetRotor()
     return "RPRT 0\n";
 }
 
-static String getDumpState()
+String getDumpState()
 {
     return "min_az=-180.00\nmax_az=180.00\nmin_el=-90.00\nmax_el=90.00\nsouth_zero=10.00\nRPRT 0\n";
 }
 
-void processCommand(String command, WiFiClient &client)
+// Moves the targets along with a tracked setpoint stream, so the rotor
+// follows the satellite instead of the last reported position
+void applyFeedForward(const Config &config, unsigned long now)
 {
-    String toSendString = "";
-    std::vector<String> output;
+    unsigned long latency = trackingLatency(controlTickMicros, config.numReadings);
+    angle_t lower;
+    angle_t upper;
 
-    command.trim();
-    if (command[0] == '/' || command[0] == '+')
-        command.remove(0, 1);
-
-    if (!command.isEmpty())
+    if (azimuthTracker.isTracking())
     {
-        Serial.println("Received command: " + command);
-        splitString(command, output);
-
-        if (output[0] == "p")
-        {
-            toSendString = getRotorCurrentPosition();
-        }
-        else if (output[0] == "P")
-        {
-            if (output.size() == 3)
-            {
-                output[1].replace(',', '.');
-                output[2].replace(',', '.');
-                toSendString = setRotorPosition(output[1].toDouble(), output[2].toDouble());
-            }
-            else
-            {
-                toSendString = "ERR Invalid command length\nRPRT -8\n";
-            }
-        }
-        else if (output[0] == "S")
-        {
-            toSendString = stopRotor();
-        }
-        else if (output[0] == "_")
-        {
-            toSendString = "Model Name: ESP32 Rotor Controller Az/El\nRPRT 0\n";
-        }
-        else if (output[0] == "q")
-        {
-            client.stop();
-            return;
-        }
-        else if (output[0] == "dump_state")
-        {
-            toSendString = getDumpState();
-        }
-        else
-        {
-            toSendString = "ERR Unknown command\nRPRT -1\n";
-        }
-
-        if (client.connected())
-        {
-            client.print(toSendString);
-        }
+        trackingLimits(rotorAzimuth.getMin(), rotorAzimuth.getMax(), ANGLE_DEGREES(-360), ANGLE_DEGREES(360), lower, upper);
+        rotorAzimuth.setTarget(azimuthTracker.predict(now, latency, lower, upper));
     }
-}
 
-void updatePosition()
-{
-    if (millis() - lastPositionUpdate >= positionUpdateInterval)
+    // Extrapolating a setting satellite must not drive the antenna below
+    // the horizon
+    if (elevationTracker.isTracking())
     {
-        lastPositionUpdate = millis();
-        rotorAzimuth.updatePosition();
-        rotorElevation.updatePosition();
+        trackingLimits(rotorElevation.getMin(), rotorElevation.getMax(), 0, ANGLE_DEGREES(90), lower, upper);
+        rotorElevation.setTarget(elevationTracker.predict(now, latency, lower, upper));
     }
 }
 
-void handleClients()
+void updatePosition(const Config &config)
 {
-    WiFiClient newClient = server.available();
-    if (newClient)
+    if (millis() - lastPositionUpdate >= config.positionUpdateInterval)
     {
-        clients.push_back(newClient);
-    }
+        unsigned long nowMicros = micros();
+        unsigned long tick = nowMicros - lastControlTickMicros;
 
-    for (int i = clients.size() - 1; i >= 0; i--)
-    {
-        WiFiClient &client = clients[i];
-        if (!client.connected())
+        lastControlTickMicros = nowMicros;
+        // Gaps from blocking calibration runs are not part of the loop latency
+        if (tick < 10000UL * config.positionUpdateInterval)
         {
-            clients.erase(clients.begin() + i);
-            continue;
+            controlTickMicros += ((long)tick - (long)controlTickMicros) / 8;
         }
 
-        if (client.available() > 0)
+        lastPositionUpdate = millis();
+        if (config.feedForward)
         {
-            String command = client.readStringUntil('\n');
-            processCommand(command, client);
+            applyFeedForward(config, lastPositionUpdate);
         }
+        rotorAzimuth.updatePosition();
+        rotorElevation.updatePosition();
+        updateTelemetry(rotorAzimuth.getCurrent(), rotorAzimuth.getTarget(), rotorElevation.getCurrent(), rotorElevation.getTarget());
+        powerNoteControlTick();
+        powerUpdate(rotorAzimuth.isAtTarget() && rotorElevation.isAtTarget());
     }
 }
 
@@ -220,18 +167,18 @@ void writeIntToEEPROM(int address, uint16_t value)
     EEPROM.write(address + 1, value & 0xFF);
 }
 
-double readDoubleFromEEPROM(int address)
+angle_t readAngleFromEEPROM(int address)
 {
     uint32_t intValue = ((uint32_t)EEPROM.read(address) << 24) |
                         ((uint32_t)EEPROM.read(address + 1) << 16) |
                         ((uint32_t)EEPROM.read(address + 2) << 8) |
                         EEPROM.read(address + 3);
-    return intValue / 100.0;
+    return (angle_t)intValue;
 }
 
-void writeDoubleToEEPROM(int address, double value)
+void writeAngleToEEPROM(int address, angle_t value)
 {
-    uint32_t intValue = value * 100;
+    uint32_t intValue = (uint32_t)value;
     EEPROM.write(address, (intValue >> 24) & 0xFF);
     EEPROM.write(address + 1, (intValue >> 16) & 0xFF);
     EEPROM.write(address + 2, (intValue >> 8) & 0xFF);
@@ -241,174 +188,212 @@ void writeDoubleToEEPROM(int address, double value)
 
 void printConfigAsTable(String comment)
 {
-    Serial.println(comment);
-    Serial.println("+-------------------------+----------------------+----------------------+");
-    Serial.println("|       Parameter         |      Stored Value    |    Current Value     |");
-    Serial.println("+-------------------------+----------------------+----------------------+");
-
-    Serial.printf("| %-23s | %20d | %20d |\n", "TCP Server Port", readIntFromEEPROM(TCP_SERVER_PORT_ADDR), tcpServerPort);
-    Serial.printf("| %-23s | %20d | %20d |\n", "Web Server Port", readIntFromEEPROM(WEBSERVER_PORT_ADDR), webServerPort);
-    Serial.printf("| %-23s | %20d | %20d |\n", "Update Interval", readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR), positionUpdateInterval);
-    Serial.printf("| %-23s | %20d | %20d |\n", "Poti Tolerance", readIntFromEEPROM(POTI_TOLERANCE_ADDR), potiTolerance);
-    Serial.printf("| %-23s | %20d | %20d |\n", "Number of Readings", readIntFromEEPROM(NUM_READINGS_ADDR), numReadings);
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Azimuth Home", readDoubleFromEEPROM(rotorAzimuth.getHomeAddr()), rotorAzimuth.getHome());
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Azimuth Min", readDoubleFromEEPROM(rotorAzimuth.getMinAddr()), rotorAzimuth.getMin());
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Azimuth Max", readDoubleFromEEPROM(rotorAzimuth.getMaxAddr()), rotorAzimuth.getMax());
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Elevation Home", readDoubleFromEEPROM(rotorElevation.getHomeAddr()), rotorElevation.getHome());
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Elevation Min", readDoubleFromEEPROM(rotorElevation.getMinAddr()), rotorElevation.getMin());
-    Serial.printf("| %-23s | %20.2f | %20.2f |\n", "Elevation Max", readDoubleFromEEPROM(rotorElevation.getMaxAddr()), rotorElevation.getMax());
-
-    Serial.println("+-------------------------+----------------------+----------------------+");
+    ConfigSnapshot config = getConfig();
+
+    LOG_INFO("%s", comment);
+    LOG_INFO("+-------------------------+----------------------+----------------------+");
+    LOG_INFO("|       Parameter         |      Stored Value    |    Current Value     |");
+    LOG_INFO("+-------------------------+----------------------+----------------------+");
+
+    LOG_INFO("| %-23s | %20d | %20d |", "TCP Server Port", readIntFromEEPROM(TCP_SERVER_PORT_ADDR), config->tcpServerPort);
+    LOG_INFO("| %-23s | %20d | %20d |", "Web Server Port", readIntFromEEPROM(WEBSERVER_PORT_ADDR), config->webServerPort);
+    LOG_INFO("| %-23s | %20d | %20d |", "Update Interval", readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR), config->positionUpdateInterval);
+    LOG_INFO("| %-23s | %20d | %20d |", "Poti Tolerance", readIntFromEEPROM(POTI_TOLERANCE_ADDR), config->potiTolerance);
+    LOG_INFO("| %-23s | %20d | %20d |", "Number of Readings", readIntFromEEPROM(NUM_READINGS_ADDR), config->numReadings);
+    LOG_INFO("| %-23s | %20d | %20d |", "Serial Mode", readIntFromEEPROM(SERIAL_MODE_ADDR), config->serialMode);
+    LOG_INFO("| %-23s | %20d | %20d |", "Feed-Forward", readIntFromEEPROM(FEED_FORWARD_ADDR), config->feedForward);
+    LOG_INFO("| %-23s | %20a | %20a |", "Azimuth Home", readAngleFromEEPROM(AZIMUTH_HOME_ADDR), config->azimuthHome);
+    LOG_INFO("| %-23s | %20a | %20a |", "Azimuth Min", readAngleFromEEPROM(AZIMUTH_MIN_ADDR), config->azimuthMin);
+    LOG_INFO("| %-23s | %20a | %20a |", "Azimuth Max", readAngleFromEEPROM(AZIMUTH_MAX_ADDR), config->azimuthMax);
+    LOG_INFO("| %-23s | %20a | %20a |", "Elevation Home", readAngleFromEEPROM(ELEVATION_HOME_ADDR), config->elevationHome);
+    LOG_INFO("| %-23s | %20a | %20a |", "Elevation Min", readAngleFromEEPROM(ELEVATION_MIN_ADDR), config->elevationMin);
+    LOG_INFO("| %-23s | %20a | %20a |", "Elevation Max", readAngleFromEEPROM(ELEVATION_MAX_ADDR), config->elevationMax);
+
+    LOG_INFO("+-------------------------+----------------------+----------------------+");
 }
 
-void loadConfig()
+// Moves debug messages off the serial port while it carries rotor commands
+// and keeps that port usable in idle mode
+void applySerialMode(int mode)
 {
-    bool save = false;
-
-    EEPROM.begin(512);
-
-    tcpServerPort = readIntFromEEPROM(TCP_SERVER_PORT_ADDR);
-    if (tcpServerPort < 1 || tcpServerPort > 65535)
+    if (mode == SERIAL_MODE_DEBUG)
     {
-        tcpServerPort = DEFAULT_TCP_SERVER_PORT;
-        save = true;
+        setDebugOutput(&Serial);
     }
-
-    webServerPort = readIntFromEEPROM(WEBSERVER_PORT_ADDR);
-    if (webServerPort < 1 || webServerPort > 65535)
+    else
     {
-        webServerPort = DEFAULT_WEBSERVER_PORT;
-        save = true;
+#if BOARD_USES_USB_SERIAL && ARDUINO_USB_CDC_ON_BOOT
+        // Serial is the USB port, UART0 stays available for debugging
+        setDebugOutput(&Serial0);
+#else
+        setDebugOutput(nullptr);
+#endif
     }
 
-    positionUpdateInterval = readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR);
-    if (positionUpdateInterval < 1)
-    {
-        positionUpdateInterval = DEFAULT_POSITION_UPDATE_INTERVAL;
-        save = true;
-    }
+#if BOARD_USES_USB_SERIAL
+    // The USB Serial/JTAG link drops in light sleep, keep it up while it
+    // carries rotor commands
+    powerSetLightSleepAllowed(mode == SERIAL_MODE_DEBUG);
+#endif
+}
 
-    potiTolerance = readIntFromEEPROM(POTI_TOLERANCE_ADDR);
-    if (potiTolerance < 0)
-    {
-        potiTolerance = DEFAULT_POTI_TOLERANCE;
-        save = true;
-    }
+// Publishes a new configuration snapshot and reconfigures only the subsystems
+// whose fields differ from the previous one. Connected clients are kept.
+void applyConfig(const Config &next)
+{
+    ConfigSnapshot previous = swapConfig(next);
 
-    numReadings = readIntFromEEPROM(NUM_READINGS_ADDR);
-    if (numReadings < 1)
+    if (previous->potiTolerance != next.potiTolerance)
     {
-        numReadings = DEFAULT_NUM_READINGS;
-        save = true;
+        rotorAzimuth.setPotiTolerance(next.potiTolerance);
+        rotorElevation.setPotiTolerance(next.potiTolerance);
     }
 
-    rotorAzimuth.setHome(readDoubleFromEEPROM(rotorAzimuth.getHomeAddr()));
-    if (rotorAzimuth.getHome() < -360.0 || rotorAzimuth.getHome() > 360.0)
+    if (previous->numReadings != next.numReadings)
     {
-        rotorAzimuth.setHome(0.0);
-        save = true;
+        rotorAzimuth.setNumReadings(next.numReadings);
+        rotorElevation.setNumReadings(next.numReadings);
     }
 
-    rotorAzimuth.setMin(readDoubleFromEEPROM(rotorAzimuth.getMinAddr()));
-    if (rotorAzimuth.getMin() < -360.0 || rotorAzimuth.getMin() > 360.0)
+    if (previous->serialMode != next.serialMode)
     {
-        rotorAzimuth.setMin(0.0);
-        save = true;
+        applySerialMode(next.serialMode);
     }
 
-    rotorAzimuth.setMax(readDoubleFromEEPROM(rotorAzimuth.getMaxAddr()));
-    if (rotorAzimuth.getMax() < -360.0 || rotorAzimuth.getMax() > 360.0)
-    {
-        rotorAzimuth.setMax(0.0);
-        save = true;
-    }
+    rotorAzimuth.setHome(next.azimuthHome);
+    rotorAzimuth.setMin(next.azimuthMin);
+    rotorAzimuth.setMax(next.azimuthMax);
+    rotorElevation.setHome(next.elevationHome);
+    rotorElevation.setMin(next.elevationMin);
+    rotorElevation.setMax(next.elevationMax);
 
-    rotorElevation.setHome(readDoubleFromEEPROM(rotorElevation.getHomeAddr()));
-    if (rotorElevation.getHome() < -360.0 || rotorElevation.getHome() > 360.0)
+    if (serversStarted && previous->tcpServerPort != next.tcpServerPort)
     {
-        rotorElevation.setHome(0.0);
-        save = true;
+        // Only the listening socket is rebound, accepted clients stay connected
+        server.end();
+        server.begin(next.tcpServerPort);
+        LOG_INFO("TCP Server moved to port %d", next.tcpServerPort);
     }
 
-    rotorElevation.setMin(readDoubleFromEEPROM(rotorElevation.getMinAddr()));
-    if (rotorElevation.getMin() < -360.0 || rotorElevation.getMin() > 360.0)
+    if (serversStarted && previous->webServerPort != next.webServerPort)
     {
-        rotorElevation.setMin(0.0);
-        save = true;
+        // The web server can not be rebound from inside one of its own handlers
+        webServerRebindPending = true;
     }
+}
 
-    rotorElevation.setMax(readDoubleFromEEPROM(rotorElevation.getMaxAddr()));
-    if (rotorElevation.getMax() < -360.0 || rotorElevation.getMax() > 360.0)
+void rebindWebServer()
+{
+    if (!webServerRebindPending)
     {
-        rotorElevation.setMax(0.0);
-        save = true;
+        return;
     }
 
+    webServerRebindPending = false;
+    webServer.stop();
+    webServer.begin(getConfig()->webServerPort);
+    LOG_INFO("Web Server moved to port %d", getConfig()->webServerPort);
+}
+
+void loadConfig()
+{
+    Config config;
+
+    EEPROM.begin(512);
+
+    config.tcpServerPort = readIntFromEEPROM(TCP_SERVER_PORT_ADDR);
+    config.webServerPort = readIntFromEEPROM(WEBSERVER_PORT_ADDR);
+    config.positionUpdateInterval = readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR);
+    config.potiTolerance = readIntFromEEPROM(POTI_TOLERANCE_ADDR);
+    config.numReadings = readIntFromEEPROM(NUM_READINGS_ADDR);
+    config.serialMode = readIntFromEEPROM(SERIAL_MODE_ADDR);
+    config.feedForward = readIntFromEEPROM(FEED_FORWARD_ADDR);
+    config.azimuthHome = readAngleFromEEPROM(AZIMUTH_HOME_ADDR);
+    config.azimuthMin = readAngleFromEEPROM(AZIMUTH_MIN_ADDR);
+    config.azimuthMax = readAngleFromEEPROM(AZIMUTH_MAX_ADDR);
+    config.elevationHome = readAngleFromEEPROM(ELEVATION_HOME_ADDR);
+    config.elevationMin = readAngleFromEEPROM(ELEVATION_MIN_ADDR);
+    config.elevationMax = readAngleFromEEPROM(ELEVATION_MAX_ADDR);
+
+    bool save = sanitizeConfig(config);
+
+    applyConfig(config);
+
     if (save)
     {
-        saveConfig();
+        saveConfig(config);
     }
 
     printConfigAsTable("loadConfig");
 }
 
-void saveConfig()
+void saveConfig(const Config &config)
 {
     EEPROM.begin(512);
 
-    if (tcpServerPort != readIntFromEEPROM(TCP_SERVER_PORT_ADDR))
+    if (config.tcpServerPort != readIntFromEEPROM(TCP_SERVER_PORT_ADDR))
     {
-        writeIntToEEPROM(TCP_SERVER_PORT_ADDR, tcpServerPort);
+        writeIntToEEPROM(TCP_SERVER_PORT_ADDR, config.tcpServerPort);
     }
 
-    if (webServerPort != readIntFromEEPROM(WEBSERVER_PORT_ADDR))
+    if (config.webServerPort != readIntFromEEPROM(WEBSERVER_PORT_ADDR))
     {
-        writeIntToEEPROM(WEBSERVER_PORT_ADDR, webServerPort);
+        writeIntToEEPROM(WEBSERVER_PORT_ADDR, config.webServerPort);
     }
 
-    if (positionUpdateInterval != readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR))
+    if (config.positionUpdateInterval != readIntFromEEPROM(POSITION_UPDATE_INTERVAL_ADDR))
     {
-        writeIntToEEPROM(POSITION_UPDATE_INTERVAL_ADDR, positionUpdateInterval);
+        writeIntToEEPROM(POSITION_UPDATE_INTERVAL_ADDR, config.positionUpdateInterval);
     }
 
-    if (potiTolerance != EEPROM.read(POTI_TOLERANCE_ADDR))
+    if (config.potiTolerance != readIntFromEEPROM(POTI_TOLERANCE_ADDR))
     {
-        writeIntToEEPROM(POTI_TOLERANCE_ADDR, potiTolerance);
+        writeIntToEEPROM(POTI_TOLERANCE_ADDR, config.potiTolerance);
     }
 
-    if (numReadings != EEPROM.read(NUM_READINGS_ADDR))
+    if (config.numReadings != readIntFromEEPROM(NUM_READINGS_ADDR))
     {
-        writeIntToEEPROM(NUM_READINGS_ADDR, numReadings);
+        writeIntToEEPROM(NUM_READINGS_ADDR, config.numReadings);
     }
 
-    if (rotorAzimuth.getHome() != readDoubleFromEEPROM(rotorAzimuth.getHomeAddr()))
+    if (config.serialMode != readIntFromEEPROM(SERIAL_MODE_ADDR))
     {
-        writeDoubleToEEPROM(rotorAzimuth.getHomeAddr(), rotorAzimuth.getHome());
+        writeIntToEEPROM(SERIAL_MODE_ADDR, config.serialMode);
     }
 
-    if (rotorElevation.getHome() != readDoubleFromEEPROM(rotorElevation.getHomeAddr()))
+    if (config.feedForward != readIntFromEEPROM(FEED_FORWARD_ADDR))
     {
-        writeDoubleToEEPROM(rotorElevation.getHomeAddr(), rotorElevation.getHome());
+        writeIntToEEPROM(FEED_FORWARD_ADDR, config.feedForward);
     }
 
-    if (rotorAzimuth.getMin() != readDoubleFromEEPROM(rotorAzimuth.getMinAddr()))
+    if (config.azimuthHome != readAngleFromEEPROM(AZIMUTH_HOME_ADDR))
     {
-        writeDoubleToEEPROM(rotorAzimuth.getMinAddr(), rotorAzimuth.getMin());
+        writeAngleToEEPROM(AZIMUTH_HOME_ADDR, config.azimuthHome);
     }
 
-    if (rotorAzimuth.getMax() != readDoubleFromEEPROM(rotorAzimuth.getMaxAddr()))
+    if (config.elevationHome != readAngleFromEEPROM(ELEVATION_HOME_ADDR))
     {
-        writeDoubleToEEPROM(rotorAzimuth.getMaxAddr(), rotorAzimuth.getMax());
+        writeAngleToEEPROM(ELEVATION_HOME_ADDR, config.elevationHome);
     }
 
-    if (rotorElevation.getMin() != readDoubleFromEEPROM(rotorElevation.getMinAddr()))
+    if (config.azimuthMin != readAngleFromEEPROM(AZIMUTH_MIN_ADDR))
     {
-        writeDoubleToEEPROM(rotorElevation.getMinAddr(), rotorElevation.getMin());
+        writeAngleToEEPROM(AZIMUTH_MIN_ADDR, config.azimuthMin);
     }
 
-    if (rotorElevation.getMax() != readDoubleFromEEPROM(rotorElevation.getMaxAddr()))
+    if (config.azimuthMax != readAngleFromEEPROM(AZIMUTH_MAX_ADDR))
     {
-        writeDoubleToEEPROM(rotorElevation.getMaxAddr(), rotorElevation.getMax());
+        writeAngleToEEPROM(AZIMUTH_MAX_ADDR, config.azimuthMax);
+    }
+
+    if (config.elevationMin != readAngleFromEEPROM(ELEVATION_MIN_ADDR))
+    {
+        writeAngleToEEPROM(ELEVATION_MIN_ADDR, config.elevationMin);
+    }
+
+    if (config.elevationMax != readAngleFromEEPROM(ELEVATION_MAX_ADDR))
+    {
+        writeAngleToEEPROM(ELEVATION_MAX_ADDR, config.elevationMax);
     }
 
     EEPROM.commit();
@@ -416,6 +401,43 @@ void saveConfig()
     printConfigAsTable("saveConfig");
 }
 
+// Stores a calibration result measured by Rotor::findMin()/findMax()
+void updateLimits()
+{
+    Config next = *getConfig();
+    next.azimuthMin = rotorAzimuth.getMin();
+    next.azimuthMax = rotorAzimuth.getMax();
+    next.elevationMin = rotorElevation.getMin();
+    next.elevationMax = rotorElevation.getMax();
+    sanitizeConfig(next);
+
+    applyConfig(next);
+    saveConfig(next);
+}
+
+// Hit rate and the cycles saved by serving hits from the cache, estimated
+// from the average cost of formatting on a miss
+String telemetryStatsToJson(const TelemetryBufferStats &stats)
+{
+    uint32_t queries = stats.hits + stats.misses;
+    uint32_t averageCycles = stats.misses > 0 ? (uint32_t)(stats.formatCycles / stats.misses) : 0;
+
+    return "{\"hits\":" + String(stats.hits) + ","
+           "\"misses\":" + String(stats.misses) + ","
+           "\"hitRatePercent\":" + String(queries > 0 ? (uint32_t)((uint64_t)stats.hits * 100 / queries) : 0) + ","
+           "\"formatCycles\":" + String(averageCycles) + ","
+           "\"savedKiloCycles\":" + String((uint32_t)((uint64_t)stats.hits * averageCycles / 1000)) + "}";
+}
+
+// Velocity in degrees per second, rejected counts setpoints that restarted
+// the estimate
+String trackerToJson(const SetpointTracker &tracker)
+{
+    return "{\"tracking\":" + String(tracker.isTracking() ? "true" : "false") + ","
+           "\"velocity\":" + angleToString(tracker.getVelocity()) + ","
+           "\"rejected\":" + String(tracker.getRejected()) + "}";
+}
+
 void setupWebInterface()
 {
     webServer.on("/", HTTP_GET, []()
@@ -426,8 +448,8 @@ void setupWebInterface()
             String html = file.readString();
             file.close();
         
-            html.replace("%AZIMUTH_HOME%", String(rotorAzimuth.getHome(), 2));
-            html.replace("%ELEVATION_HOME%", String(rotorElevation.getHome(), 2));
+            html.replace("%AZIMUTH_HOME%", angleToString(rotorAzimuth.getHome()));
+            html.replace("%ELEVATION_HOME%", angleToString(rotorElevation.getHome()));
             webServer.send(200, "text/html", html);
         } else {
         webServer.send(404, "text/plain", "File not found");
@@ -436,8 +458,8 @@ void setupWebInterface()
     webServer.on("/api/set_position", HTTP_GET, []()
                  {
         if (webServer.hasArg("azimuth") && webServer.hasArg("elevation")) {
-        double azimuth = webServer.arg("azimuth").toDouble();
-        double elevation = webServer.arg("elevation").toDouble();
+        angle_t azimuth = stringToAngle(webServer.arg("azimuth"));
+        angle_t elevation = stringToAngle(webServer.arg("elevation"));
         setRotorPosition(azimuth, elevation);
         webServer.send(200, "text/plain", "Position set successfully.");
         } else {
@@ -451,28 +473,66 @@ void setupWebInterface()
 
     webServer.on("/api/coordinates", HTTP_GET, []()
                  {
-        String json = "{\"azimuth\":\"" + String(rotorAzimuth.getCurrent(), 2) + "\","
-                    "\"azimuthTarget\":\"" + String(rotorAzimuth.getTarget(), 2) + "\","
-                    "\"elevation\":\"" + String(rotorElevation.getCurrent(), 2) + "\","
-                    "\"elevationTarget\":\"" + String(rotorElevation.getTarget(), 2) + "\"}";
+        size_t length;
+        const char *json = getCoordinatesJson(length);
+        webServer.send_P(200, "application/json", json, length); });
+
+    webServer.on("/api/telemetry-stats", HTTP_GET, []()
+                 {
+        TelemetryBufferStats position = getPositionReplyStats();
+        TelemetryBufferStats easycomm = getEasycommReplyStats();
+        TelemetryBufferStats coordinates = getCoordinatesJsonStats();
+        String json = "{\"version\":" + String(getTelemetryVersion()) + ","
+                    "\"position\":" + telemetryStatsToJson(position) + ","
+                    "\"easycomm\":" + telemetryStatsToJson(easycomm) + ","
+                    "\"coordinates\":" + telemetryStatsToJson(coordinates) + "}";
+        webServer.send(200, "application/json", json); });
+
+    webServer.on("/api/tracking", HTTP_GET, []()
+                 {
+        String json = "{\"feedForward\":" + String(getConfig()->feedForward ? "true" : "false") + ","
+                    "\"controlTickUs\":" + String(controlTickMicros) + ","
+                    "\"latencyMs\":" + String(trackingLatency(controlTickMicros, getConfig()->numReadings)) + ","
+                    "\"azimuth\":" + trackerToJson(azimuthTracker) + ","
+                    "\"elevation\":" + trackerToJson(elevationTracker) + "}";
         webServer.send(200, "application/json", json); });
 
+    webServer.on("/api/power", HTTP_GET, []()
+                 {
+        String json = "{\"mode\":\"" + String(powerGetMode() == POWER_MODE_IDLE ? "idle" : "active") + "\","
+                    "\"cpuFreqMhz\":" + String(getCpuFrequencyMhz()) + ","
+                    "\"lightSleep\":" + String(powerLightSleepActive() ? "true" : "false") + ","
+                    "\"lastCommandToTickUs\":" + String(powerGetLastCommandToTick()) + ","
+                    "\"maxCommandToTickUs\":" + String(powerGetMaxCommandToTick()) + "}";
+        webServer.send(200, "application/json", json); });
+
+    webServer.on("/api/log", HTTP_GET, []()
+                 {
+        if (webServer.hasArg("level")) {
+            logSetLevel(constrain(webServer.arg("level").toInt(), LOG_LEVEL_DEBUG, LOG_LEVEL_NONE));
+        }
+        webServer.sendHeader("X-Log-Level", String(logGetLevel()));
+        webServer.sendHeader("X-Log-Dropped", String(logDropped()));
+        webServer.send(200, "text/plain", logTail()); });
+
     webServer.on("/api/current-config", HTTP_GET, []()
                  {
-        printConfigAsTable("/api/current-config");
+        ConfigSnapshot config = getConfig();
 
         String json = "{";
-        json += "\"tcp_server_port\":" + String(tcpServerPort) + ",";
-        json += "\"web_server_port\":" + String(webServerPort) + ",";
-        json += "\"position_update_interval\":" + String(positionUpdateInterval) + ",";
-        json += "\"poti_tolerance\":" + String(potiTolerance) + ",";
-        json += "\"num_readings\":" + String(numReadings) + ",";
-        json += "\"azimuth_home\":" + String(rotorAzimuth.getHome(), 2) + ",";
-        json += "\"azimuth_min\":" + String(rotorAzimuth.getMin(), 2) + ",";
-        json += "\"azimuth_max\":" + String(rotorAzimuth.getMax(), 2) + ",";
-        json += "\"elevation_home\":" + String(rotorElevation.getHome(), 2) + ",";
-        json += "\"elevation_min\":" + String(rotorElevation.getMin(), 2) + ",";
-        json += "\"elevation_max\":" + String(rotorElevation.getMax(), 2);
+        json += "\"tcp_server_port\":" + String(config->tcpServerPort) + ",";
+        json += "\"web_server_port\":" + String(config->webServerPort) + ",";
+        json += "\"position_update_interval\":" + String(config->positionUpdateInterval) + ",";
+        json += "\"poti_tolerance\":" + String(config->potiTolerance) + ",";
+        json += "\"num_readings\":" + String(config->numReadings) + ",";
+        json += "\"serial_mode\":" + String(config->serialMode) + ",";
+        json += "\"feed_forward\":" + String(config->feedForward) + ",";
+        json += "\"azimuth_home\":" + angleToString(config->azimuthHome) + ",";
+        json += "\"azimuth_min\":" + angleToString(config->azimuthMin) + ",";
+        json += "\"azimuth_max\":" + angleToString(config->azimuthMax) + ",";
+        json += "\"elevation_home\":" + angleToString(config->elevationHome) + ",";
+        json += "\"elevation_min\":" + angleToString(config->elevationMin) + ",";
+        json += "\"elevation_max\":" + angleToString(config->elevationMax);
         json += "}";
 
         webServer.send(200, "application/json", json); });
@@ -492,19 +552,30 @@ void setupWebInterface()
     webServer.on("/configure", HTTP_POST, []()
                  {
     if (webServer.hasArg("tcp_server_port") && webServer.hasArg("position_update_interval") && webServer.hasArg("azimuth_home") && webServer.hasArg("elevation_home")) {
-        tcpServerPort = webServer.arg("tcp_server_port").toInt();
-        positionUpdateInterval = webServer.arg("position_update_interval").toInt();
-        rotorAzimuth.setHome(webServer.arg("azimuth_home").toDouble());
-        rotorElevation.setHome(webServer.arg("elevation_home").toDouble());
-        potiTolerance = webServer.arg("poti_tolerance").toInt();
-        webServerPort = webServer.arg("web_server_port").toInt();
-        numReadings = webServer.arg("num_readings").toInt();
-
-        saveConfig();
+        Config next = *getConfig();
+        next.tcpServerPort = webServer.arg("tcp_server_port").toInt();
+        next.positionUpdateInterval = webServer.arg("position_update_interval").toInt();
+        next.azimuthHome = stringToAngle(webServer.arg("azimuth_home"));
+        next.elevationHome = stringToAngle(webServer.arg("elevation_home"));
+        if (webServer.hasArg("poti_tolerance")) {
+            next.potiTolerance = webServer.arg("poti_tolerance").toInt();
+        }
+        if (webServer.hasArg("web_server_port")) {
+            next.webServerPort = webServer.arg("web_server_port").toInt();
+        }
+        if (webServer.hasArg("num_readings")) {
+            next.numReadings = webServer.arg("num_readings").toInt();
+        }
+        if (webServer.hasArg("serial_mode")) {
+            next.serialMode = webServer.arg("serial_mode").toInt();
+        }
+        if (webServer.hasArg("feed_forward")) {
+            next.feedForward = webServer.arg("feed_forward").toInt();
+        }
+        sanitizeConfig(next);
 
-        server.close();
-        server = WiFiServer(tcpServerPort);
-        server.begin();
+        applyConfig(next);
+        saveConfig(next);
 
         webServer.sendHeader("Location", "/configure", true);
         webServer.send(302, "text/plain", ""); 
@@ -522,13 +593,15 @@ void setupWebInterface()
                  {
         if (webServer.hasArg("poti")) {
             int potiId = webServer.arg("poti").toInt();            
-            Serial.println(potiId);
+            LOG_DEBUG("findMin poti %d", potiId);
             if(potiId == 0) {
                 rotorAzimuth.findMin();
+                updateLimits();
                 webServer.send(200, "text/plain", "Min value saved.");
             }
             else if(potiId == 1) {
                 rotorElevation.findMin();
+                updateLimits();
                 webServer.send(200, "text/plain", "Min value saved.");
             } else {
                 webServer.send(400, "text/plain", "Invalid poti ID.");
@@ -545,10 +618,12 @@ void setupWebInterface()
             
             if(potiId == 0) {
                 rotorAzimuth.findMax();
+                updateLimits();
                 webServer.send(200, "text/plain", "Min value saved.");
             }
             else if(potiId == 1) {
                 rotorElevation.findMax();
+                updateLimits();
                 webServer.send(200, "text/plain", "Min value saved.");
             } else {
                 webServer.send(400, "text/plain", "Invalid poti ID.");
@@ -557,13 +632,21 @@ void setupWebInterface()
             webServer.send(400, "text/plain", "Missing poti parameter.");
     } });
 
-    webServer.begin();
-    Serial.printf("\nTCP Server started on port %d\n", tcpServerPort);
+    webServer.begin(getConfig()->webServerPort);
+    LOG_INFO("TCP Server started on port %d", getConfig()->tcpServerPort);
 }
 
 void setup()
 {
     Serial.begin(115200);
+#if BOARD_USES_USB_SERIAL && ARDUINO_USB_CDC_ON_BOOT
+    Serial0.begin(115200);
+#endif
+    logBegin();
+
+#ifdef ROTOR_BENCHMARK
+    runBenchmarks();
+#endif
 
     loadConfig();
 
@@ -572,18 +655,31 @@ void setup()
 
     if (!SPIFFS.begin(true))
     {
-        Serial.println("An Error has occurred while mounting SPIFFS");
+        LOG_ERROR("An Error has occurred while mounting SPIFFS");
         return;
     }
 
+    wifiManager.setDebugOutput(getConfig()->serialMode == SERIAL_MODE_DEBUG);
     wifiManager.autoConnect();
-    server.begin();
+    powerInit();
+    server.begin(getConfig()->tcpServerPort);
     setupWebInterface();
+    serversStarted = true;
 }
 
 void loop()
 {
-    updatePosition();
-    handleClients();
+    // One snapshot per iteration, a change made by a handler below takes
+    // effect in the next one
+    ConfigSnapshot config = getConfig();
+
+    updatePosition(*config);
+    handleClients(server);
+    if (config->serialMode != SERIAL_MODE_DEBUG)
+    {
+        handleSerial(Serial, config->serialMode);
+    }
     webServer.handleClient();
+    rebindWebServer();
+    powerSleepUntil(lastPositionUpdate + config->positionUpdateInterval);
 }
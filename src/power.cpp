@@ -0,0 +1,186 @@
+#include "power.h"
+#include <WiFi.h>
+#include "log.h"
+#include <esp_pm.h>
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR < 5
+#include <esp32c3/pm.h>
+#endif
+
+static PowerMode powerMode = POWER_MODE_ACTIVE;
+static bool pmSupported = false;
+static bool lightSleepActive = false;
+static bool lightSleepAllowed = true;
+static bool atTarget = false;
+static unsigned long atTargetSince = 0;
+static unsigned long commandStart = 0;
+static bool wakePending = false;
+static unsigned long lastCommandToTick = 0;
+static unsigned long maxCommandToTick = 0;
+
+// Returns false when the IDF was built without CONFIG_PM_ENABLE
+static bool configurePowerManagement(int maxFreq, int minFreq, bool lightSleep)
+{
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32c3_t config = {};
+#endif
+    config.max_freq_mhz = maxFreq;
+    config.min_freq_mhz = minFreq;
+    config.light_sleep_enable = lightSleep;
+    return esp_pm_configure(&config) == ESP_OK;
+}
+
+static void enterActiveMode()
+{
+    if (pmSupported)
+    {
+        configurePowerManagement(POWER_ACTIVE_CPU_FREQ_MHZ, POWER_ACTIVE_CPU_FREQ_MHZ, false);
+    }
+    else
+    {
+        setCpuFrequencyMhz(POWER_ACTIVE_CPU_FREQ_MHZ);
+    }
+    lightSleepActive = false;
+    powerMode = POWER_MODE_ACTIVE;
+}
+
+static void enterIdleMode()
+{
+    if (pmSupported)
+    {
+        // Light sleep additionally needs CONFIG_FREERTOS_USE_TICKLESS_IDLE,
+        // without it the call fails and only the clock is scaled
+        lightSleepActive = lightSleepAllowed && configurePowerManagement(POWER_IDLE_CPU_FREQ_MHZ, POWER_IDLE_MIN_FREQ_MHZ, true);
+        if (!lightSleepActive)
+        {
+            configurePowerManagement(POWER_IDLE_CPU_FREQ_MHZ, POWER_IDLE_MIN_FREQ_MHZ, false);
+        }
+    }
+    else
+    {
+        // Without the IDF power manager only the CPU clock can be lowered,
+        // Wi-Fi needs at least 80 MHz.
+        setCpuFrequencyMhz(POWER_IDLE_CPU_FREQ_MHZ);
+    }
+    powerMode = POWER_MODE_IDLE;
+}
+
+void powerInit()
+{
+    // Modem sleep is required for automatic light sleep while Wi-Fi is connected
+    WiFi.setSleep(true);
+
+    pmSupported = configurePowerManagement(POWER_ACTIVE_CPU_FREQ_MHZ, POWER_ACTIVE_CPU_FREQ_MHZ, false);
+    if (!pmSupported)
+    {
+        LOG_WARN("Power management not available, falling back to CPU frequency scaling");
+    }
+
+    enterActiveMode();
+}
+
+// Light sleep stops peripherals that can not wake the chip, like the USB
+// Serial/JTAG link. Idle mode then only lowers the clock.
+void powerSetLightSleepAllowed(bool allowed)
+{
+    lightSleepAllowed = allowed;
+
+    if (powerMode == POWER_MODE_IDLE && lightSleepActive != allowed)
+    {
+        enterIdleMode();
+    }
+}
+
+void powerUpdate(bool rotorsAtTarget)
+{
+    unsigned long now = millis();
+
+    if (!rotorsAtTarget)
+    {
+        atTarget = false;
+        if (powerMode == POWER_MODE_IDLE)
+        {
+            enterActiveMode();
+        }
+        return;
+    }
+
+    if (!atTarget)
+    {
+        atTarget = true;
+        atTargetSince = now;
+    }
+
+    if (powerMode == POWER_MODE_ACTIVE && now - atTargetSince >= DEFAULT_IDLE_ENTER_DELAY)
+    {
+        enterIdleMode();
+    }
+}
+
+void powerWake()
+{
+    atTarget = false;
+
+    if (powerMode == POWER_MODE_IDLE)
+    {
+        commandStart = micros();
+        wakePending = true;
+        enterActiveMode();
+    }
+}
+
+void powerSleepUntil(unsigned long nextTick)
+{
+    if (powerMode != POWER_MODE_IDLE)
+    {
+        return;
+    }
+
+    // Blocking the loop task lets the idle task run, which is where the
+    // power manager enters light sleep. The control tick and incoming
+    // network data (at the next DTIM beacon) wake the chip up again.
+    long remaining = (long)(nextTick - millis());
+    if (remaining > 0)
+    {
+        delay(remaining);
+    }
+}
+
+// Time from a command arriving in idle mode to the control tick acting on
+// it. It starts once the command has been received, so the light sleep
+// wake-up and the wait for the DTIM beacon are not included.
+void powerNoteControlTick()
+{
+    if (wakePending)
+    {
+        lastCommandToTick = micros() - commandStart;
+        if (lastCommandToTick > maxCommandToTick)
+        {
+            maxCommandToTick = lastCommandToTick;
+        }
+        wakePending = false;
+    }
+}
+
+PowerMode powerGetMode()
+{
+    return powerMode;
+}
+
+// True while the power manager was successfully configured for light sleep
+bool powerLightSleepActive()
+{
+    return lightSleepActive;
+}
+
+unsigned long powerGetLastCommandToTick()
+{
+    return lastCommandToTick;
+}
+
+unsigned long powerGetMaxCommandToTick()
+{
+    return maxCommandToTick;
+}
@@ -0,0 +1,31 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+// CPU frequencies used by the two power modes (MHz)
+#define POWER_ACTIVE_CPU_FREQ_MHZ 160
+#define POWER_IDLE_CPU_FREQ_MHZ 80
+#define POWER_IDLE_MIN_FREQ_MHZ 40
+
+// Time both axes have to sit at their target before entering idle mode (ms)
+#define DEFAULT_IDLE_ENTER_DELAY 5000
+
+enum PowerMode
+{
+    POWER_MODE_ACTIVE,
+    POWER_MODE_IDLE
+};
+
+void powerInit();
+void powerSetLightSleepAllowed(bool allowed);
+void powerUpdate(bool rotorsAtTarget);
+void powerWake();
+void powerSleepUntil(unsigned long nextTick);
+void powerNoteControlTick();
+PowerMode powerGetMode();
+bool powerLightSleepActive();
+unsigned long powerGetLastCommandToTick();
+unsigned long powerGetMaxCommandToTick();
+
+#endif
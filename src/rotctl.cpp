@@ -0,0 +1,204 @@
+#include "rotctl.h"
+#include <vector>
+#include "log.h"
+#include "telemetry.h"
+
+static std::vector<WiFiClient> clients;
+static String serialLine;
+
+static void splitString(const String &input, std::vector<String> &output)
+{
+    int start = 0;
+    int end;
+    while ((end = input.indexOf(' ', start)) != -1)
+    {
+        output.push_back(input.substring(start, end));
+        start = end + 1;
+    }
+    output.push_back(input.substring(start));
+}
+
+// Executes one rotctl command and writes the reply. Returns false if the
+// client asked to close the connection.
+bool processCommand(String command, Print &reply)
+{
+    String toSendString = "";
+    std::vector<String> output;
+
+    command.trim();
+    if (command[0] == '/' || command[0] == '+')
+        command.remove(0, 1);
+
+    if (!command.isEmpty())
+    {
+        LOG_DEBUG("Received command: %s", command);
+        splitString(command, output);
+
+        if (output[0] == "p")
+        {
+            // Shared reply, formatted at most once per control tick
+            size_t length;
+            const char *cached = getPositionReply(length);
+            reply.write((const uint8_t *)cached, length);
+            return true;
+        }
+        else if (output[0] == "P")
+        {
+            if (output.size() == 3)
+            {
+                angle_t azimuth;
+                angle_t elevation;
+                parseAngle(output[1].c_str(), azimuth);
+                parseAngle(output[2].c_str(), elevation);
+                toSendString = setRotorPosition(azimuth, elevation);
+            }
+            else
+            {
+                toSendString = "ERR Invalid command length\nRPRT -8\n";
+            }
+        }
+        else if (output[0] == "S")
+        {
+            toSendString = stopRotor();
+        }
+        else if (output[0] == "_")
+        {
+            toSendString = "Model Name: ESP32 Rotor Controller Az/El\nRPRT 0\n";
+        }
+        else if (output[0] == "q")
+        {
+            return false;
+        }
+        else if (output[0] == "dump_state")
+        {
+            toSendString = getDumpState();
+        }
+        else
+        {
+            toSendString = "ERR Unknown command\nRPRT -1\n";
+        }
+
+        reply.print(toSendString);
+    }
+
+    return true;
+}
+
+// Easycomm II as sent by Hamlib: "AZ12.3 EL45.6" sets a position, "AZ EL"
+// queries it and "SA SE" stops. Only queries are answered.
+void processEasycommCommand(String command, Print &reply)
+{
+    std::vector<String> output;
+    angle_t azimuth;
+    angle_t elevation;
+    bool setPosition = false;
+    bool query = false;
+
+    command.trim();
+    if (command.isEmpty())
+    {
+        return;
+    }
+
+    LOG_DEBUG("Received command: %s", command);
+    getRotorTarget(azimuth, elevation);
+    splitString(command, output);
+
+    for (const String &token : output)
+    {
+        if (token == "AZ" || token == "EL")
+        {
+            query = true;
+        }
+        else if (token.startsWith("AZ"))
+        {
+            parseAngle(token.c_str() + 2, azimuth);
+            setPosition = true;
+        }
+        else if (token.startsWith("EL"))
+        {
+            parseAngle(token.c_str() + 2, elevation);
+            setPosition = true;
+        }
+        else if (token == "SA" || token == "SE")
+        {
+            stopRotor();
+        }
+    }
+
+    if (setPosition)
+    {
+        setRotorPosition(azimuth, elevation);
+    }
+
+    if (query)
+    {
+        // Shared reply, formatted at most once per control tick
+        size_t length;
+        const char *cached = getEasycommReply(length);
+        reply.write((const uint8_t *)cached, length);
+    }
+}
+
+void handleClients(WiFiServer &server)
+{
+    WiFiClient newClient = server.available();
+    if (newClient)
+    {
+        clients.push_back(newClient);
+    }
+
+    for (int i = clients.size() - 1; i >= 0; i--)
+    {
+        WiFiClient &client = clients[i];
+        if (!client.connected())
+        {
+            clients.erase(clients.begin() + i);
+            continue;
+        }
+
+        if (client.available() > 0)
+        {
+            String command = client.readStringUntil('\n');
+            if (!processCommand(command, client))
+            {
+                client.stop();
+            }
+        }
+    }
+}
+
+// Collects characters without blocking until a line is complete, so a
+// partial command never stalls the control loop.
+void handleSerial(Stream &serial, int mode)
+{
+    while (serial.available() > 0)
+    {
+        char c = serial.read();
+
+        if (c != '\n' && c != '\r')
+        {
+            if (serialLine.length() < MAX_COMMAND_LENGTH)
+            {
+                serialLine += c;
+            }
+            continue;
+        }
+
+        if (serialLine.isEmpty())
+        {
+            continue;
+        }
+
+        if (mode == SERIAL_MODE_EASYCOMM)
+        {
+            processEasycommCommand(serialLine, serial);
+        }
+        else
+        {
+            // There is no connection to close on a serial port, "q" is ignored
+            processCommand(serialLine, serial);
+        }
+        serialLine = "";
+    }
+}
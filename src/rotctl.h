@@ -0,0 +1,26 @@
+#ifndef ROTCTL_H
+#define ROTCTL_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "angle.h"
+
+// What the serial port is used for
+#define SERIAL_MODE_DEBUG 0    // Debug messages only
+#define SERIAL_MODE_ROTCTL 1   // rotctl commands like on the TCP port
+#define SERIAL_MODE_EASYCOMM 2 // Easycomm II, for Hamlib's serial easycomm backend
+
+#define MAX_COMMAND_LENGTH 64
+
+// Rotor access, implemented by the application
+String setRotorPosition(angle_t azimuth, angle_t elevation);
+String stopRotor();
+String getDumpState();
+void getRotorTarget(angle_t &azimuth, angle_t &elevation);
+
+bool processCommand(String command, Print &reply);
+void processEasycommCommand(String command, Print &reply);
+void handleClients(WiFiServer &server);
+void handleSerial(Stream &serial, int mode);
+
+#endif
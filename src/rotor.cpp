@@ -1,9 +1,8 @@
-#include "Rotor.h"
+#include "rotor.h"
 
-Rotor::Rotor(double home, int homeAddr, double min, int minAddr, double max, int maxAddr, int gpioPinRight, int gpioPinLeft, int gpioPinPoti, int potiTolerance, int numReadings)
-    : current(0), target(0), home(0), homeAddr(homeAddr), min(0), minAddr(minAddr), max(0), maxAddr(maxAddr),
-      gpioPinRight(gpioPinRight), gpioPinLeft(gpioPinLeft), gpioPinPoti(gpioPinPoti), potiTolerance(potiTolerance), numReadings(numReadings),
-      readIndex(0), total(0), average(0)
+Rotor::Rotor(angle_t home, int homeAddr, angle_t min, int minAddr, angle_t max, int maxAddr, int potiTolerance, int numReadings)
+    : current(0), target(0), home(home), homeAddr(homeAddr), min(min), minAddr(minAddr), max(max), maxAddr(maxAddr),
+      numReadings(numReadings), readIndex(0), total(0), average(0), potiTolerance(potiTolerance)
 {
     readings = new int[numReadings];
 
@@ -20,9 +19,7 @@ Rotor::~Rotor()
 
 void Rotor::initialize()
 {
-    pinMode(gpioPinRight, OUTPUT);
-    pinMode(gpioPinLeft, OUTPUT);
-    pinMode(gpioPinPoti, INPUT);
+    setupPins();
 
     stop();
 
@@ -38,22 +35,22 @@ void Rotor::initialize()
     }
 }
 
-double Rotor::getCurrent() const
+angle_t Rotor::getCurrent() const
 {
     return current;
 }
 
-double Rotor::getTarget() const
+angle_t Rotor::getTarget() const
 {
     return target;
 }
 
-void Rotor::setTarget(double value)
+void Rotor::setTarget(angle_t value)
 {
     this->target = value;
 }
 
-double Rotor::getHome() const
+angle_t Rotor::getHome() const
 {
     return home;
 }
@@ -63,15 +60,42 @@ int Rotor::getHomeAddr()
     return homeAddr;
 }
 
-void Rotor::setHome(double value)
+void Rotor::setHome(angle_t value)
 {
     this->home = value;
 }
 
+void Rotor::setPotiTolerance(int value)
+{
+    this->potiTolerance = value;
+}
+
+void Rotor::setNumReadings(int value)
+{
+    if (value < 1 || value == numReadings)
+    {
+        return;
+    }
+
+    // Seed the new filter with the current average so the position does not
+    // jump while the buffer refills.
+    int *resized = new int[value];
+    for (int i = 0; i < value; i++)
+    {
+        resized[i] = average;
+    }
+
+    delete[] readings;
+    readings = resized;
+    numReadings = value;
+    readIndex = 0;
+    total = average * value;
+}
+
 void Rotor::updatePosition()
 {
     total = total - readings[readIndex];
-    readings[readIndex] = analogRead(gpioPinPoti) / 4;
+    readings[readIndex] = readPoti() / 4;
     total = total + readings[readIndex];
 
     readIndex++;
@@ -81,9 +105,9 @@ void Rotor::updatePosition()
     }
 
     average = total / numReadings;
-    current = average;
+    current = (angle_t)average * ANGLE_SCALE;
 
-    if (abs(target - current) <= potiTolerance)
+    if (isAtTarget())
     {
         stop();
     }
@@ -97,16 +121,9 @@ void Rotor::updatePosition()
     }
 }
 
-void Rotor::moveLeft()
+bool Rotor::isAtTarget() const
 {
-    digitalWrite(gpioPinRight, LOW);
-    digitalWrite(gpioPinLeft, HIGH);
-}
-
-void Rotor::moveRight()
-{
-    digitalWrite(gpioPinRight, HIGH);
-    digitalWrite(gpioPinLeft, LOW);
+    return abs(target - current) <= (angle_t)potiTolerance * ANGLE_SCALE;
 }
 
 void Rotor::moveHome()
@@ -114,22 +131,16 @@ void Rotor::moveHome()
     this->setTarget(this->getHome());
 }
 
-void Rotor::stop()
-{
-    digitalWrite(gpioPinRight, LOW);
-    digitalWrite(gpioPinLeft, LOW);
-}
-
 void Rotor::findMin()
 {
-    int minValue = analogRead(gpioPinPoti);
+    int minValue = readPoti();
     int stableCount = 0;
 
     moveLeft();
 
     while (stableCount < 3)
     {
-        int currentValue = analogRead(gpioPinPoti);
+        int currentValue = readPoti();
         if (currentValue < minValue - potiTolerance)
         {
             minValue = currentValue;
@@ -147,17 +158,17 @@ void Rotor::findMin()
 
     stop();
 
-    min = minValue;
-    EEPROM.write(minAddr, minValue);
-    EEPROM.commit();
+    // Same scale as current, see updatePosition(). Storing is left to the
+    // caller, the limits are part of the configuration.
+    min = (angle_t)(minValue / 4) * ANGLE_SCALE;
 }
 
-void Rotor::setMin(double value)
+void Rotor::setMin(angle_t value)
 {
     this->min = value;
 }
 
-double Rotor::getMin()
+angle_t Rotor::getMin()
 {
     return min;
 }
@@ -169,14 +180,14 @@ int Rotor::getMinAddr()
 
 void Rotor::findMax()
 {
-    int maxValue = analogRead(gpioPinPoti);
+    int maxValue = readPoti();
     int stableCount = 0;
 
     moveRight();
 
     while (stableCount < 3)
     {
-        int currentValue = analogRead(gpioPinPoti);
+        int currentValue = readPoti();
         if (currentValue > maxValue + potiTolerance)
         {
             maxValue = currentValue;
@@ -194,17 +205,16 @@ void Rotor::findMax()
 
     stop();
 
-    max = maxValue;
-    EEPROM.write(maxAddr, maxValue);
-    EEPROM.commit();
+    // Same scale as current, see updatePosition()
+    max = (angle_t)(maxValue / 4) * ANGLE_SCALE;
 }
 
-void Rotor::setMax(double value)
+void Rotor::setMax(angle_t value)
 {
     this->max = value;
 }
 
-double Rotor::getMax()
+angle_t Rotor::getMax()
 {
     return max;
 }
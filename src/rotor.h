@@ -3,21 +3,19 @@
 
 #include <EEPROM.h>
 #include <Arduino.h>
+#include "angle.h"
 
 class Rotor
 {
 private:
-    double current;
-    double target;
-    double home;
+    angle_t current;
+    angle_t target;
+    angle_t home;
     int homeAddr;
-    double min;
+    angle_t min;
     int minAddr;
-    double max;
+    angle_t max;
     int maxAddr;
-    int gpioPinRight;
-    int gpioPinLeft;
-    int gpioPinPoti;
 
     int *readings;
     int numReadings;
@@ -27,31 +25,39 @@ private:
     int potiTolerance;
 
 public:
-    Rotor(double home, int homeAddr, double min, int minAddr, double max, int maxAddr, int gpioPinRight, int gpioPinLeft, int gpioPinPoti, int potiTolerance, int numReadings);
+    Rotor(angle_t home, int homeAddr, angle_t min, int minAddr, angle_t max, int maxAddr, int potiTolerance, int numReadings);
 
-    ~Rotor();
+    virtual ~Rotor();
 
     void initialize();
-    double getCurrent() const;
-    double getTarget() const;
-    double getHome() const;
+    angle_t getCurrent() const;
+    angle_t getTarget() const;
+    angle_t getHome() const;
     int getHomeAddr();
-    void setTarget(double value);
-    void setHome(double value);
+    void setTarget(angle_t value);
+    void setHome(angle_t value);
+    void setPotiTolerance(int value);
+    void setNumReadings(int value);
     void updatePosition();
+    bool isAtTarget() const;
     void findMin();
-    void setMin(double value);
-    double getMin();
+    void setMin(angle_t value);
+    angle_t getMin();
     int getMinAddr();
-    void setMax(double value);
-    double getMax();
+    void setMax(angle_t value);
+    angle_t getMax();
     int getMaxAddr();
     void findMax();
     void reset();
-    void moveLeft();
-    void moveRight();
+    virtual void moveLeft() = 0;
+    virtual void moveRight() = 0;
     void moveHome();
-    void stop();
+    virtual void stop() = 0;
+
+protected:
+    // Hardware access is provided by BoardRotor for the selected board
+    virtual void setupPins() = 0;
+    virtual int readPoti() = 0;
 };
 
 #endif
@@ -0,0 +1,131 @@
+#include "telemetry.h"
+#include <string.h>
+
+struct TelemetryBuffer
+{
+    char data[128];
+    size_t length;
+    uint32_t version;
+    TelemetryBufferStats stats;
+};
+
+static angle_t currentAzimuth;
+static angle_t currentAzimuthTarget;
+static angle_t currentElevation;
+static angle_t currentElevationTarget;
+// Starts at 1 so the empty buffers (version 0) are formatted on first use
+static uint32_t version = 1;
+
+static TelemetryBuffer positionReply;
+static TelemetryBuffer easycommReply;
+static TelemetryBuffer coordinatesJson;
+
+static size_t append(char *buffer, size_t length, const char *text)
+{
+    size_t size = strlen(text);
+    memcpy(buffer + length, text, size);
+    return length + size;
+}
+
+static void formatPositionReply(char *buffer, size_t &length)
+{
+    length = formatAngle(currentAzimuth, buffer);
+    buffer[length++] = '\n';
+    length += formatAngle(currentElevation, buffer + length);
+    length = append(buffer, length, "\nRPRT 0\n");
+}
+
+static void formatEasycommReply(char *buffer, size_t &length)
+{
+    length = append(buffer, 0, "AZ");
+    length += formatAngle(currentAzimuth, buffer + length);
+    length = append(buffer, length, " EL");
+    length += formatAngle(currentElevation, buffer + length);
+    buffer[length++] = '\n';
+}
+
+static void formatCoordinatesJson(char *buffer, size_t &length)
+{
+    length = append(buffer, 0, "{\"azimuth\":\"");
+    length += formatAngle(currentAzimuth, buffer + length);
+    length = append(buffer, length, "\",\"azimuthTarget\":\"");
+    length += formatAngle(currentAzimuthTarget, buffer + length);
+    length = append(buffer, length, "\",\"elevation\":\"");
+    length += formatAngle(currentElevation, buffer + length);
+    length = append(buffer, length, "\",\"elevationTarget\":\"");
+    length += formatAngle(currentElevationTarget, buffer + length);
+    length = append(buffer, length, "\"}");
+    buffer[length] = '\0';
+}
+
+static const char *getBuffer(TelemetryBuffer &buffer, void (*format)(char *, size_t &), size_t &length)
+{
+    if (buffer.version == version)
+    {
+        buffer.stats.hits++;
+    }
+    else
+    {
+        uint32_t start = ESP.getCycleCount();
+        format(buffer.data, buffer.length);
+        buffer.stats.formatCycles += ESP.getCycleCount() - start;
+        buffer.stats.misses++;
+        buffer.version = version;
+    }
+
+    length = buffer.length;
+    return buffer.data;
+}
+
+void updateTelemetry(angle_t azimuth, angle_t azimuthTarget, angle_t elevation, angle_t elevationTarget)
+{
+    if (azimuth == currentAzimuth && azimuthTarget == currentAzimuthTarget &&
+        elevation == currentElevation && elevationTarget == currentElevationTarget)
+    {
+        return;
+    }
+
+    currentAzimuth = azimuth;
+    currentAzimuthTarget = azimuthTarget;
+    currentElevation = elevation;
+    currentElevationTarget = elevationTarget;
+    version++;
+}
+
+uint32_t getTelemetryVersion()
+{
+    return version;
+}
+
+// rotctl reply to "p"
+const char *getPositionReply(size_t &length)
+{
+    return getBuffer(positionReply, formatPositionReply, length);
+}
+
+// Easycomm II reply to "AZ EL"
+const char *getEasycommReply(size_t &length)
+{
+    return getBuffer(easycommReply, formatEasycommReply, length);
+}
+
+// Body of /api/coordinates
+const char *getCoordinatesJson(size_t &length)
+{
+    return getBuffer(coordinatesJson, formatCoordinatesJson, length);
+}
+
+TelemetryBufferStats getPositionReplyStats()
+{
+    return positionReply.stats;
+}
+
+TelemetryBufferStats getEasycommReplyStats()
+{
+    return easycommReply.stats;
+}
+
+TelemetryBufferStats getCoordinatesJsonStats()
+{
+    return coordinatesJson.stats;
+}
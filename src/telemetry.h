@@ -0,0 +1,27 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "angle.h"
+
+// Replies to position queries are formatted at most once per control tick
+// and shared by all clients. The control loop publishes the new position
+// with updateTelemetry(), which bumps the version only if a value changed.
+// Each buffer is formatted on the first query after a version change.
+struct TelemetryBufferStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint64_t formatCycles;
+};
+
+void updateTelemetry(angle_t azimuth, angle_t azimuthTarget, angle_t elevation, angle_t elevationTarget);
+uint32_t getTelemetryVersion();
+const char *getPositionReply(size_t &length);
+const char *getEasycommReply(size_t &length);
+const char *getCoordinatesJson(size_t &length);
+TelemetryBufferStats getPositionReplyStats();
+TelemetryBufferStats getEasycommReplyStats();
+TelemetryBufferStats getCoordinatesJsonStats();
+
+#endif
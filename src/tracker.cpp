@@ -0,0 +1,136 @@
+#include "tracker.h"
+#include <stdlib.h>
+
+SetpointTracker::SetpointTracker()
+    : lastSetpoint(0), lastTime(0), interval(0), velocity(0), samples(0), hasSetpoint(false), rejected(0)
+{
+}
+
+void SetpointTracker::restart(angle_t setpoint, unsigned long now)
+{
+    lastSetpoint = setpoint;
+    lastTime = now;
+    velocity = 0;
+    samples = 0;
+    hasSetpoint = true;
+}
+
+void SetpointTracker::addSetpoint(angle_t setpoint, unsigned long now)
+{
+    if (!hasSetpoint)
+    {
+        restart(setpoint, now);
+        return;
+    }
+
+    unsigned long elapsed = now - lastTime;
+
+    if (elapsed > TRACKER_TIMEOUT)
+    {
+        restart(setpoint, now);
+        return;
+    }
+
+    if (elapsed == 0)
+    {
+        // Several setpoints within one millisecond carry no velocity information
+        lastSetpoint = setpoint;
+        return;
+    }
+
+    int32_t expected = lastSetpoint + (int32_t)((int64_t)velocity * (int64_t)elapsed / 1000);
+    int32_t measured = (int32_t)((int64_t)(setpoint - lastSetpoint) * 1000 / (int64_t)elapsed);
+
+    if (abs(setpoint - expected) > TRACKER_MAX_JUMP || abs(measured) > TRACKER_MAX_VELOCITY)
+    {
+        rejected++;
+        restart(setpoint, now);
+        return;
+    }
+
+    // Exponential average over the last few intervals, client timing jitter
+    // and the two decimals of the protocol make single estimates noisy
+    velocity = samples == 0 ? measured : velocity + (measured - velocity) / 2;
+    interval = samples == 0 ? elapsed : interval + ((long)elapsed - (long)interval) / 2;
+    if (samples < 255)
+    {
+        samples++;
+    }
+    lastSetpoint = setpoint;
+    lastTime = now;
+}
+
+void SetpointTracker::reset()
+{
+    hasSetpoint = false;
+    velocity = 0;
+    samples = 0;
+}
+
+bool SetpointTracker::isTracking() const
+{
+    return hasSetpoint && samples >= TRACKER_MIN_SAMPLES;
+}
+
+// Where the target will be once a command issued now takes effect, kept
+// within lower and upper unless the client itself commanded a value outside.
+// If the next setpoint is overdue by TRACKER_STALE_FACTOR intervals the
+// client has stopped sending, e.g. at LOS, and the last commanded setpoint
+// is returned instead.
+angle_t SetpointTracker::predict(unsigned long now, unsigned long latency, angle_t lower, angle_t upper) const
+{
+    unsigned long elapsed = now - lastTime;
+
+    if (!isTracking() || elapsed > TRACKER_STALE_FACTOR * interval)
+    {
+        return lastSetpoint;
+    }
+
+    angle_t predicted = lastSetpoint + (int32_t)((int64_t)velocity * (int64_t)(elapsed + latency) / 1000);
+
+    // Extrapolation never goes further out than the commanded setpoint
+    if (lastSetpoint < lower)
+    {
+        lower = lastSetpoint;
+    }
+    if (lastSetpoint > upper)
+    {
+        upper = lastSetpoint;
+    }
+    return predicted < lower ? lower : (predicted > upper ? upper : predicted);
+}
+
+int32_t SetpointTracker::getVelocity() const
+{
+    return velocity;
+}
+
+uint32_t SetpointTracker::getRejected() const
+{
+    return rejected;
+}
+
+void trackingLimits(angle_t min, angle_t max, angle_t lowest, angle_t highest, angle_t &lower, angle_t &upper)
+{
+    lower = lowest;
+    upper = highest;
+
+    // Uncalibrated axes have min == max == 0
+    if (max > min)
+    {
+        lower = min > lowest ? min : lowest;
+        upper = max < highest ? max : highest;
+    }
+
+    // Limits that do not overlap the window are ignored
+    if (lower > upper)
+    {
+        lower = lowest;
+        upper = highest;
+    }
+}
+
+unsigned long trackingLatency(unsigned long controlTickMicros, int numReadings)
+{
+    return controlTickMicros * numReadings / 2000;
+}
@@ -0,0 +1,51 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdint.h>
+#include "angle.h"
+
+#define TRACKER_TIMEOUT 10000                     // ms between setpoints after which the estimate restarts
+#define TRACKER_MAX_JUMP ANGLE_DEGREES(10)        // Largest accepted deviation from the predicted setpoint
+#define TRACKER_MAX_VELOCITY ANGLE_DEGREES(15)    // Per second, faster setpoint changes are jumps
+#define TRACKER_MIN_SAMPLES 2                     // Velocity estimates needed before extrapolating
+#define TRACKER_STALE_FACTOR 2                    // Setpoint intervals without setpoint before extrapolation stops
+
+// Follows the stream of setpoints a tracking program sends for one axis.
+// Each setpoint is timestamped on arrival, the target velocity is estimated
+// from consecutive setpoints and smoothed. A setpoint that does not fit the
+// stream (a new pass, a manual move, a long pause) restarts the estimate
+// instead of being used as a velocity sample.
+class SetpointTracker
+{
+private:
+    angle_t lastSetpoint;
+    unsigned long lastTime;
+    unsigned long interval; // Observed time between setpoints, ms
+    int32_t velocity; // Centidegrees per second
+    uint8_t samples;
+    bool hasSetpoint;
+    uint32_t rejected;
+
+    void restart(angle_t setpoint, unsigned long now);
+
+public:
+    SetpointTracker();
+
+    void addSetpoint(angle_t setpoint, unsigned long now);
+    void reset();
+    bool isTracking() const;
+    angle_t predict(unsigned long now, unsigned long latency, angle_t lower, angle_t upper) const;
+    int32_t getVelocity() const;
+    uint32_t getRejected() const;
+};
+
+// Window extrapolated targets are kept in: [lowest, highest], narrowed to
+// the calibrated limits min and max of the axis if those are set
+void trackingLimits(angle_t min, angle_t max, angle_t lowest, angle_t highest, angle_t &lower, angle_t &upper);
+
+// Delay between a new target and the filtered position reacting to it in ms:
+// half a control tick on average until the target is used, plus the group
+// delay of the moving average, (numReadings - 1) / 2 ticks.
+unsigned long trackingLatency(unsigned long controlTickMicros, int numReadings);
+
+#endif
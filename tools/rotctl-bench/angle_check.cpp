@@ -0,0 +1,206 @@
+// Checks that parseAngle()/formatAngle() (src/angle.cpp) answer exactly like
+// the floating point path they replaced: String::toDouble() with ',' replaced
+// by '.', which is atof(), and String(value, 2), which is "%.2f". Built with
+// UBSan, so overflows in the integer path fail the check as well:
+//
+//   angle-check
+//
+// Two differences are intended and listed as such: angle_t has no negative
+// zero, so "-0.00" becomes "0.00", and values beyond +-21474835 degrees
+// saturate. "inf" and "nan" parse as no number.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "angle.h"
+
+#define ANGLE_SATURATION 21474835 // Largest whole degrees parseAngle() keeps
+#define FUZZ_CASES 200000
+
+struct Case
+{
+    const char *input;
+    const char *expected; // nullptr if the old path's reply is expected
+};
+
+static const Case cases[] = {
+    {"0", nullptr},
+    {"12", nullptr},
+    {"-12", nullptr},
+    {"+7.1", nullptr},
+    {".5", nullptr},
+    {"-.5", nullptr},
+    {"12,5", nullptr},
+    {"123,456", nullptr},
+    {"1,5,3", nullptr},
+    {"  90", nullptr},
+    {" \t\n-3.5", nullptr},
+    {"12abc", nullptr},
+    {"45.675", nullptr},
+    {"0.125", nullptr},
+    {"1.005", nullptr},
+    {"-0.005", nullptr},
+    {"359.995", nullptr},
+    {"359.9949999", nullptr},
+    {"359.9950000001", nullptr},
+    {"0.12500000000000000001", nullptr},
+    {"0.00499999999999999999999", nullptr},
+    {"1.23456789012345678", nullptr},
+    {"1e2", nullptr},
+    {"12.345e1", nullptr},
+    {"-2.5E-1", nullptr},
+    {"0x1A", nullptr},
+    {"abc", nullptr},
+    {"", nullptr},
+    {"-", nullptr},
+    {"+", nullptr},
+    {".", nullptr},
+    {"--5", nullptr},
+    {"21474835", nullptr},
+    {"-21474835", nullptr},
+    {"21474835.99", nullptr},
+    {"21474835.995", nullptr},
+    {"-21474835.999", nullptr},
+    // No negative zero in angle_t
+    {"-0", "0.00"},
+    {"-0.001", "0.00"},
+    {"-0.004999", "0.00"},
+    // Saturation
+    {"21474836", "21474835.00"},
+    {"99999999999", "21474835.00"},
+    {"-99999999999", "-21474835.00"},
+    {"99999999999.99", "21474835.00"},
+    {"1e10", "21474835.00"},
+    {"-1e300", "-21474835.00"},
+    {"1e999", "21474835.00"},
+    // Not a number
+    {"inf", "0.00"},
+    {"-nan", "0.00"},
+};
+
+static std::string legacy(const char *text)
+{
+    std::string copy(text);
+    char buffer[512];
+
+    std::replace(copy.begin(), copy.end(), ',', '.');
+    snprintf(buffer, sizeof(buffer), "%.2f", atof(copy.c_str()));
+    return buffer;
+}
+
+// The old reply with the intended differences applied, for generated input
+static std::string expected(const char *text)
+{
+    std::string copy(text);
+
+    std::replace(copy.begin(), copy.end(), ',', '.');
+    double number = atof(copy.c_str());
+    if (number >= ANGLE_SATURATION + 1.0)
+    {
+        return "21474835.00";
+    }
+    if (number <= -ANGLE_SATURATION - 1.0)
+    {
+        return "-21474835.00";
+    }
+
+    std::string reply = legacy(text);
+    return reply == "-0.00" ? "0.00" : reply;
+}
+
+static std::string fixedPoint(const char *text)
+{
+    angle_t value;
+    char buffer[ANGLE_STRING_SIZE];
+
+    parseAngle(text, value);
+    formatAngle(value, buffer);
+    return buffer;
+}
+
+static int failures = 0;
+
+static void compare(const char *input, const std::string &want)
+{
+    std::string got = fixedPoint(input);
+    if (got != want)
+    {
+        printf("  \"%s\": got %s, expected %s\n", input, got.c_str(), want.c_str());
+        failures++;
+    }
+}
+
+// Random decimals in the forms clients send, a quarter of them decimal ties
+static std::string randomAngle(uint32_t &seed)
+{
+    auto next = [&seed](uint32_t range)
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % range;
+    };
+    static const char *signs[] = {"", "", "-", "+"};
+    static const char *separators[] = {".", ".", ",", ""};
+    static const char *suffixes[] = {"", "", "", "x", "e1", "abc"};
+    std::string text = signs[next(4)];
+
+    int wholeDigits = next(10);
+    for (int i = 0; i < wholeDigits; i++)
+    {
+        text += (char)('0' + next(10));
+    }
+
+    text += separators[next(4)];
+    int fractionDigits = next(22);
+    bool tie = next(4) == 0;
+    for (int i = 0; i < fractionDigits; i++)
+    {
+        text += (char)(tie && i == 2 ? '5' : (tie && i > 2 ? '0' : '0' + next(10)));
+    }
+
+    text += suffixes[next(6)];
+    return text;
+}
+
+int main()
+{
+    for (const Case &c : cases)
+    {
+        compare(c.input, c.expected ? c.expected : legacy(c.input));
+    }
+    int tableFailures = failures;
+
+    uint32_t seed = 1;
+    for (int i = 0; i < FUZZ_CASES; i++)
+    {
+        std::string text = randomAngle(seed);
+        compare(text.c_str(), expected(text.c_str()));
+    }
+    int fuzzFailures = failures - tableFailures;
+
+    // Every representable value formats like "%.2f" and parses back to itself
+    for (angle_t value = -ANGLE_DEGREES(100000); value <= ANGLE_DEGREES(100000); value++)
+    {
+        char text[ANGLE_STRING_SIZE];
+        char want[32];
+        angle_t parsed;
+
+        formatAngle(value, text);
+        snprintf(want, sizeof(want), "%.2f", value / 100.0);
+        parseAngle(text, parsed);
+        if (std::string(text) != want || parsed != value)
+        {
+            printf("  %d: formatted %s, expected %s, parsed back %d\n", (int)value, text, want, (int)parsed);
+            failures++;
+        }
+    }
+    int roundTripFailures = failures - tableFailures - fuzzFailures;
+
+    printf("table: %zu cases, %d failed\n", sizeof(cases) / sizeof(cases[0]), tableFailures);
+    printf("generated: %d cases, %d failed\n", FUZZ_CASES, fuzzFailures);
+    printf("round trip: %d values, %d failed\n", 2 * ANGLE_DEGREES(100000) + 1, roundTripFailures);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+// Minimal Arduino API for building the firmware's command engine on Linux.
+// Only what the firmware sources built by the Makefile use is provided.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+inline unsigned long millis()
+{
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : value(text != nullptr ? text : "") {}
+    String(char c) : value(1, c) {}
+    String(const std::string &text) : value(text) {}
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    void reserve(unsigned int size) { value.reserve(size); }
+
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+    bool operator==(const char *text) const { return value == text; }
+    bool operator==(const String &other) const { return value == other.value; }
+    bool operator!=(const char *text) const { return value != text; }
+
+    String &operator+=(const String &other)
+    {
+        value += other.value;
+        return *this;
+    }
+
+    String &operator+=(char c)
+    {
+        value += c;
+        return *this;
+    }
+
+    friend String operator+(const String &a, const String &b) { return String(a.value + b.value); }
+    friend String operator+(const char *a, const String &b) { return String(a + b.value); }
+    friend String operator+(const String &a, const char *b) { return String(a.value + b); }
+
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t index = value.find(c, from);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < value.size() && to > from ? String(value.substr(from, to - from)) : String(); }
+    bool startsWith(const char *prefix) const { return value.compare(0, strlen(prefix), prefix) == 0; }
+
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < value.size())
+        {
+            value.erase(index, count);
+        }
+    }
+
+    void trim()
+    {
+        const char *space = " \t\r\n";
+        size_t first = value.find_first_not_of(space);
+        if (first == std::string::npos)
+        {
+            value.clear();
+            return;
+        }
+        value = value.substr(first, value.find_last_not_of(space) - first + 1);
+    }
+
+private:
+    std::string value;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+        while (size-- > 0)
+        {
+            written += write(*buffer++);
+        }
+        return written;
+    }
+
+    size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+    size_t println(const char *text) { return print(text) + print("\n"); }
+    size_t println(const String &text) { return print(text) + print("\n"); }
+
+    size_t printf(const char *format, ...)
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return length > 0 ? write((const uint8_t *)buffer, std::min((size_t)length, sizeof(buffer) - 1)) : 0;
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+
+    // Like Arduino, waits up to one second for the terminator
+    String readStringUntil(char terminator)
+    {
+        std::string line;
+        unsigned long start = millis();
+        while (millis() - start < 1000)
+        {
+            int c = available() > 0 ? read() : -1;
+            if (c < 0)
+            {
+                continue;
+            }
+            if (c == terminator)
+            {
+                break;
+            }
+            line += (char)c;
+        }
+        return String(line);
+    }
+};
+
+class HostSerial : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        return fputc(c, stdout) == EOF ? 0 : 1;
+    }
+};
+
+extern HostSerial Serial;
+
+class HostEsp
+{
+public:
+    uint32_t getCycleCount()
+    {
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+extern HostEsp ESP;
+
+#endif
@@ -0,0 +1,18 @@
+// Erased EEPROM that ignores writes, enough to build rotor.cpp on Linux.
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <cstdint>
+
+class EEPROMClass
+{
+public:
+    uint8_t read(int) { return 0xFF; }
+    void write(int, uint8_t) {}
+    bool commit() { return true; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,158 @@
+// WiFiServer and WiFiClient on top of POSIX sockets, so the firmware's
+// handleClients() can serve real TCP connections on Linux.
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include <cerrno>
+#include <memory>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class WiFiClient : public Stream
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : socket(std::make_shared<Socket>(fd)) {}
+
+    explicit operator bool() const { return socket && socket->fd >= 0; }
+
+    bool connected()
+    {
+        if (!*this)
+        {
+            return false;
+        }
+
+        char c;
+        ssize_t result = recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    int available() override
+    {
+        int pending = 0;
+        if (!*this || ioctl(socket->fd, FIONREAD, &pending) < 0)
+        {
+            return 0;
+        }
+        return pending;
+    }
+
+    int read() override
+    {
+        unsigned char c;
+        return *this && recv(socket->fd, &c, 1, MSG_DONTWAIT) == 1 ? c : -1;
+    }
+
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        if (!*this)
+        {
+            return 0;
+        }
+        ssize_t sent = send(socket->fd, buffer, size, MSG_NOSIGNAL);
+        return sent > 0 ? sent : 0;
+    }
+
+    void stop()
+    {
+        if (socket && socket->fd >= 0)
+        {
+            close(socket->fd);
+            socket->fd = -1;
+        }
+    }
+
+private:
+    // Shared between copies like the lwIP socket handle of the real WiFiClient
+    struct Socket
+    {
+        int fd;
+        explicit Socket(int fd) : fd(fd) {}
+        ~Socket()
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    };
+
+    std::shared_ptr<Socket> socket;
+};
+
+class WiFiServer
+{
+public:
+    explicit WiFiServer(uint16_t port) : port(port), fd(-1) {}
+    ~WiFiServer() { end(); }
+
+    void begin(uint16_t listenPort = 0)
+    {
+        if (listenPort != 0)
+        {
+            port = listenPort;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (sockaddr *)&address, sizeof(address)) < 0 || listen(fd, 16) < 0)
+        {
+            perror("WiFiServer");
+            end();
+            return;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+
+    WiFiClient available()
+    {
+        int client = fd >= 0 ? accept(fd, nullptr, nullptr) : -1;
+        if (client < 0)
+        {
+            return WiFiClient();
+        }
+        int enable = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        return WiFiClient(client);
+    }
+
+    void end()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    uint16_t port;
+    int fd;
+};
+
+#endif
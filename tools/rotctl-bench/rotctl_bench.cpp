@@ -0,0 +1,548 @@
+// Load generator and latency benchmark for rotctl endpoints. Connects N
+// simulated clients over TCP (or one over a serial port) and sends a mix of
+// commands at a configurable rate, e.g.
+//
+//   rotctl-bench -H 192.168.1.50 -n 1000
+//   rotctl-bench -d /dev/ttyACM0 -n 1000
+//   rotctl-bench -d /dev/ttyACM0 -e -c "AZ EL"
+//   rotctl-bench -H 192.168.1.50 -C 8 -m p=80,P=10,S=5,dump_state=5 -r 5 -T 3600 -R 60
+//
+// Each client sends its next command once the previous reply was received
+// completely. Latencies are kept in log-scale histograms, so soak runs of any
+// length use constant memory.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+struct CommandWeight
+{
+    std::string command;
+    int weight;
+};
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    std::string port = "4533";
+    std::string device;
+    std::vector<CommandWeight> mix = {{"p", 1}};
+    bool easycomm = false;
+    int clients = 1;
+    long count = 1000;
+    double rate = 0;
+    int durationS = 0;
+    int reportS = 0;
+    int timeoutMs = 2000;
+};
+
+// Log-scale latency histogram, 16 buckets per power of two (about 4% error)
+class Histogram
+{
+public:
+    static const int bucketsPerOctave = 16;
+    static const int bucketCount = 32 * bucketsPerOctave;
+
+    Histogram() : buckets(bucketCount, 0), samples(0), max(0) {}
+
+    void add(long us)
+    {
+        int index = us < 1 ? 0 : std::min(bucketCount - 1, (int)(std::log2((double)us) * bucketsPerOctave));
+        buckets[index]++;
+        samples++;
+        max = std::max(max, us);
+    }
+
+    void merge(const Histogram &other)
+    {
+        for (int i = 0; i < bucketCount; i++)
+        {
+            buckets[i] += other.buckets[i];
+        }
+        samples += other.samples;
+        max = std::max(max, other.max);
+    }
+
+    long percentile(double fraction) const
+    {
+        long rank = (long)std::ceil(fraction * samples);
+        long seen = 0;
+        for (int i = 0; i < bucketCount; i++)
+        {
+            seen += buckets[i];
+            if (seen >= rank && seen > 0)
+            {
+                return std::min(max, (long)std::pow(2.0, (double)(i + 1) / bucketsPerOctave));
+            }
+        }
+        return max;
+    }
+
+    long count() const
+    {
+        return samples;
+    }
+
+    long maximum() const
+    {
+        return max;
+    }
+
+private:
+    std::vector<long> buckets;
+    long samples;
+    long max;
+};
+
+struct Stats
+{
+    std::vector<Histogram> latency;
+    long errors = 0;
+    long timeouts = 0;
+    long disconnects = 0;
+
+    explicit Stats(size_t commands) : latency(commands) {}
+
+    void merge(const Stats &other)
+    {
+        for (size_t i = 0; i < latency.size(); i++)
+        {
+            latency[i].merge(other.latency[i]);
+        }
+        errors += other.errors;
+        timeouts += other.timeouts;
+        disconnects += other.disconnects;
+    }
+};
+
+static std::atomic<bool> stopRequested(false);
+static std::atomic<int> runningClients(0);
+static std::mutex statsMutex;
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-H host] [-p port] [-d serial-device] [-e] [-C clients]\n"
+            "          [-c command | -m cmd=weight,...] [-n count] [-r rate] [-T seconds]\n"
+            "          [-R seconds] [-t timeout-ms]\n"
+            "  -e  Easycomm II mode, replies are a single line instead of ending with RPRT\n"
+            "  -C  number of concurrent TCP clients\n"
+            "  -m  command mix, e.g. p=80,P=10,S=5,dump_state=5 (P gets random angles)\n"
+            "  -n  commands per client, ignored if -T is given\n"
+            "  -r  commands per second per client, 0 sends back to back\n"
+            "  -T  run for the given number of seconds\n"
+            "  -R  print an interval report every given number of seconds\n",
+            name);
+    exit(2);
+}
+
+static std::vector<CommandWeight> parseMix(const std::string &text)
+{
+    std::vector<CommandWeight> mix;
+    size_t start = 0;
+
+    while (start < text.size())
+    {
+        size_t end = text.find(',', start);
+        std::string item = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        size_t equals = item.find('=');
+        CommandWeight entry = {item.substr(0, equals), equals == std::string::npos ? 1 : atoi(item.c_str() + equals + 1)};
+        if (!entry.command.empty() && entry.weight > 0)
+        {
+            mix.push_back(entry);
+        }
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+
+    return mix;
+}
+
+static int openTcp(const Options &options)
+{
+    addrinfo hints = {};
+    addrinfo *result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &result) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo *address = result; address != nullptr; address = address->ai_next)
+    {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0)
+        {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+    return fd;
+}
+
+static int openSerial(const Options &options)
+{
+    int fd = open(options.device.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // The USB CDC port ignores the baud rate, it only has to be raw
+    termios tty = {};
+    tcgetattr(fd, &tty);
+    cfmakeraw(&tty);
+    cfsetspeed(&tty, B115200);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+enum ReplyResult
+{
+    REPLY_OK,
+    REPLY_ERROR,
+    REPLY_TIMEOUT,
+    REPLY_DISCONNECTED
+};
+
+// Reads until the reply is complete: a line starting with "RPRT" for rotctl,
+// any full line for Easycomm. A non-zero RPRT code counts as an error.
+static ReplyResult readReply(int fd, bool easycomm, int timeoutMs, std::string &buffer)
+{
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    for (;;)
+    {
+        size_t lineStart = 0;
+        size_t lineEnd;
+        while ((lineEnd = buffer.find('\n', lineStart)) != std::string::npos)
+        {
+            bool report = buffer.compare(lineStart, 4, "RPRT") == 0;
+            bool failed = report && buffer.compare(lineStart, 7, "RPRT 0\n") != 0;
+            size_t next = lineEnd + 1;
+            if (easycomm || report)
+            {
+                buffer.erase(0, next);
+                return failed ? REPLY_ERROR : REPLY_OK;
+            }
+            lineStart = next;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        if (remaining.count() <= 0)
+        {
+            return REPLY_TIMEOUT;
+        }
+
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, remaining.count());
+        if (ready == 0)
+        {
+            return REPLY_TIMEOUT;
+        }
+
+        char chunk[256];
+        ssize_t received = ready > 0 ? read(fd, chunk, sizeof(chunk)) : -1;
+        if (received <= 0)
+        {
+            return REPLY_DISCONNECTED;
+        }
+        buffer.append(chunk, received);
+    }
+}
+
+static void runClient(const Options &options, int id, Stats &stats)
+{
+    std::mt19937 random(id * 7919 + 1);
+    std::vector<int> weights;
+    for (const CommandWeight &entry : options.mix)
+    {
+        weights.push_back(entry.weight);
+    }
+    std::discrete_distribution<size_t> pickCommand(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> azimuth(0, 35999);
+    std::uniform_int_distribution<int> elevation(0, 9000);
+
+    auto interval = options.rate > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate)) : Clock::duration::zero();
+    auto nextSend = Clock::now();
+    std::string buffer;
+    int fd = -1;
+
+    for (long sent = 0; !stopRequested && (options.durationS > 0 || sent < options.count); sent++)
+    {
+        if (fd < 0)
+        {
+            fd = options.device.empty() ? openTcp(options) : openSerial(options);
+            if (fd < 0)
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.errors++;
+                usleep(100000);
+                continue;
+            }
+            buffer.clear();
+        }
+
+        size_t index = pickCommand(random);
+        std::string line = options.mix[index].command;
+        if (line == "P")
+        {
+            char angles[32];
+            int az = azimuth(random);
+            int el = elevation(random);
+            snprintf(angles, sizeof(angles), " %d.%02d %d.%02d", az / 100, az % 100, el / 100, el % 100);
+            line += angles;
+        }
+        line += "\n";
+
+        if (interval > Clock::duration::zero())
+        {
+            std::this_thread::sleep_until(nextSend);
+            nextSend += interval;
+        }
+
+        auto start = Clock::now();
+        ReplyResult result = write(fd, line.data(), line.size()) == (ssize_t)line.size()
+                                 ? readReply(fd, options.easycomm, options.timeoutMs, buffer)
+                                 : REPLY_DISCONNECTED;
+        long us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        switch (result)
+        {
+        case REPLY_OK:
+            stats.latency[index].add(us);
+            break;
+        case REPLY_ERROR:
+            stats.latency[index].add(us);
+            stats.errors++;
+            break;
+        case REPLY_TIMEOUT:
+            // The late reply would be taken for the next one, start over
+            stats.timeouts++;
+            close(fd);
+            fd = -1;
+            break;
+        case REPLY_DISCONNECTED:
+            stats.disconnects++;
+            close(fd);
+            fd = -1;
+            break;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    runningClients--;
+}
+
+static void printLatency(const char *name, const Histogram &histogram, double seconds)
+{
+    if (histogram.count() == 0)
+    {
+        printf("  %-12s %10s\n", name, "-");
+        return;
+    }
+
+    printf("  %-12s %10ld %9.1f/s %9ld %9ld %9ld us\n", name, histogram.count(), histogram.count() / seconds,
+           histogram.percentile(0.50), histogram.percentile(0.99), histogram.maximum());
+}
+
+static void printReport(const char *title, const Options &options, const Stats &stats, double seconds)
+{
+    Histogram all;
+
+    printf("%s (%.0f s, %d clients)\n", title, seconds, options.clients);
+    printf("  %-12s %10s %11s %9s %9s %9s\n", "command", "replies", "rate", "p50", "p99", "max");
+    for (size_t i = 0; i < options.mix.size(); i++)
+    {
+        printLatency(options.mix[i].command.c_str(), stats.latency[i], seconds);
+        all.merge(stats.latency[i]);
+    }
+    if (options.mix.size() > 1)
+    {
+        printLatency("all", all, seconds);
+    }
+    printf("  errors %ld, timeouts %ld, disconnects %ld\n", stats.errors, stats.timeouts, stats.disconnects);
+    fflush(stdout);
+}
+
+static void handleSignal(int)
+{
+    stopRequested = true;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:p:d:eC:c:m:n:r:T:R:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'H':
+            options.host = optarg;
+            break;
+        case 'p':
+            options.port = optarg;
+            break;
+        case 'd':
+            options.device = optarg;
+            break;
+        case 'e':
+            options.easycomm = true;
+            break;
+        case 'C':
+            options.clients = atoi(optarg);
+            break;
+        case 'c':
+            options.mix = {{optarg, 1}};
+            break;
+        case 'm':
+            options.mix = parseMix(optarg);
+            break;
+        case 'n':
+            options.count = atol(optarg);
+            break;
+        case 'r':
+            options.rate = atof(optarg);
+            break;
+        case 'T':
+            options.durationS = atoi(optarg);
+            break;
+        case 'R':
+            options.reportS = atoi(optarg);
+            break;
+        case 't':
+            options.timeoutMs = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (options.clients < 1 || options.count < 1 || options.mix.empty() || (!options.device.empty() && options.clients != 1))
+    {
+        usage(argv[0]);
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    // A closed connection shows up as a failed write, not as a signal
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("transport  %s\n", options.device.empty() ? "tcp" : "serial");
+
+    std::vector<Stats> clientStats(options.clients, Stats(options.mix.size()));
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+
+    runningClients = options.clients;
+    for (int i = 0; i < options.clients; i++)
+    {
+        threads.emplace_back(runClient, std::cref(options), i, std::ref(clientStats[i]));
+    }
+
+    // Interval reports and the duration limit are handled here, the clients
+    // only record into their own Stats.
+    if (options.durationS > 0 || options.reportS > 0)
+    {
+        Stats total(options.mix.size());
+        auto lastReport = start;
+
+        for (;;)
+        {
+            auto now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            bool finished = stopRequested || runningClients == 0 || (options.durationS > 0 && elapsed >= options.durationS);
+
+            if (options.reportS > 0 && (std::chrono::duration<double>(now - lastReport).count() >= options.reportS || finished))
+            {
+                Stats interval(options.mix.size());
+                {
+                    std::lock_guard<std::mutex> lock(statsMutex);
+                    for (Stats &stats : clientStats)
+                    {
+                        interval.merge(stats);
+                        stats = Stats(options.mix.size());
+                    }
+                }
+                total.merge(interval);
+                printReport("interval", options, interval, std::chrono::duration<double>(now - lastReport).count());
+                lastReport = now;
+            }
+
+            if (finished)
+            {
+                stopRequested = true;
+                break;
+            }
+
+            usleep(100000);
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (Stats &stats : clientStats)
+        {
+            total.merge(stats);
+        }
+        printReport("total", options, total, std::chrono::duration<double>(Clock::now() - start).count());
+        return total.errors + total.timeouts + total.disconnects == 0 ? 0 : 1;
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    Stats total(options.mix.size());
+    for (Stats &stats : clientStats)
+    {
+        total.merge(stats);
+    }
+    printReport("total", options, total, std::chrono::duration<double>(Clock::now() - start).count());
+    return total.errors + total.timeouts + total.disconnects == 0 ? 0 : 1;
+}
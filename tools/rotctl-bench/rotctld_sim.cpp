@@ -0,0 +1,128 @@
+// Runs the firmware's rotctl command engine (src/rotctl.cpp) natively with
+// simulated rotors, serving real TCP connections on the loopback interface.
+// Together with rotctl-bench this exercises processCommand() and
+// handleClients() without hardware:
+//
+//   rotctld-sim -p 4533 &
+//   rotctl-bench -C 16 -m p=80,P=10,S=5,dump_state=5 -r 20 -T 600 -R 60
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "rotctl.h"
+#include "debug.h"
+#include "log.h"
+#include "telemetry.h"
+
+HostSerial Serial;
+HostEsp ESP;
+
+// Simulated axis moving towards its target at a fixed speed
+struct SimulatedAxis
+{
+    angle_t current = 0;
+    angle_t target = 0;
+
+    void step(angle_t maxStep)
+    {
+        angle_t error = target - current;
+        current += error > maxStep ? maxStep : (error < -maxStep ? -maxStep : error);
+    }
+};
+
+static SimulatedAxis azimuth;
+static SimulatedAxis elevation;
+static volatile bool running = true;
+
+String setRotorPosition(angle_t azimuthTarget, angle_t elevationTarget)
+{
+    azimuth.target = azimuthTarget;
+    elevation.target = elevationTarget;
+    return "RPRT 0\n";
+}
+
+String stopRotor()
+{
+    azimuth.target = azimuth.current;
+    elevation.target = elevation.current;
+    return "RPRT 0\n";
+}
+
+String getDumpState()
+{
+    return "min_az=-180.00\nmax_az=180.00\nmin_el=-90.00\nmax_el=90.00\nsouth_zero=10.00\nRPRT 0\n";
+}
+
+void getRotorTarget(angle_t &azimuthTarget, angle_t &elevationTarget)
+{
+    azimuthTarget = azimuth.target;
+    elevationTarget = elevation.target;
+}
+
+static void handleSignal(int)
+{
+    running = false;
+}
+
+int main(int argc, char **argv)
+{
+    int port = 4533;
+    unsigned long interval = 10;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:i:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'i':
+            interval = atol(optarg);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-i tick-ms] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    setDebugOutput(verbose ? &Serial : nullptr);
+    logSetLevel(verbose ? LOG_LEVEL_DEBUG : LOG_LEVEL_INFO);
+
+    WiFiServer server(port);
+    server.begin();
+    printf("rotctld-sim listening on 127.0.0.1:%d\n", port);
+    fflush(stdout);
+
+    // Same structure as loop() in main.cpp: a control tick every interval,
+    // clients polled in between
+    unsigned long lastPositionUpdate = 0;
+    while (running)
+    {
+        if (millis() - lastPositionUpdate >= interval)
+        {
+            lastPositionUpdate = millis();
+            azimuth.step(6);
+            elevation.step(6);
+            updateTelemetry(azimuth.current, azimuth.target, elevation.current, elevation.target);
+        }
+
+        handleClients(server);
+        // Stands in for the drain task of the firmware
+        logDrain();
+        usleep(50);
+    }
+
+    TelemetryBufferStats stats = getPositionReplyStats();
+    printf("position replies: %u hits, %u misses\n", stats.hits, stats.misses);
+    return 0;
+}
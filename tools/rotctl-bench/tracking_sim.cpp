@@ -0,0 +1,356 @@
+// Tracks two simulated LEO passes with the firmware's Rotor control loop
+// (src/rotor.cpp) and setpoint tracker (src/tracker.cpp) and reports the
+// pointing error with velocity feed-forward off and on:
+//
+//   tracking-sim -u 1000 -i 10 -n 64
+//
+// The client behaves like Gpredict: it sends the satellite position every
+// update interval with some timing jitter and parks the rotor at the next
+// AOS position between passes, which makes the setpoint stream jump. The
+// client then stops sending, either at LOS of the last pass or halfway
+// through it. The rotor must settle at the last commanded position instead
+// of following the extrapolation. Both are run once more with calibrated
+// limits narrower than the full range, which the extrapolation must respect.
+// Everything runs in simulated time, a run takes well under a second.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <cmath>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+#include "rotor.h"
+#include "tracker.h"
+
+EEPROMClass EEPROM;
+
+#define EARTH_RADIUS 6371.0 // km
+#define ORBIT_ALTITUDE 550.0
+#define ORBIT_PERIOD 5736.0 // s at 550 km
+#define PARK_TIME 90000     // ms between passes
+#define END_TIME 30000      // ms simulated after the client stopped sending
+
+static const double degreesPerRadian = 180.0 / M_PI;
+
+// Motor and potentiometer of one axis. One degree is four ADC counts, the
+// scale Rotor::updatePosition() assumes.
+class SimulatedRotor : public Rotor
+{
+public:
+    double position;
+    double speed; // Degrees per second
+    int direction;
+    uint32_t noise;
+
+    SimulatedRotor(double position, double speed, int potiTolerance, int numReadings)
+        : Rotor(0, 0, 0, 0, 0, 0, potiTolerance, numReadings), position(position), speed(speed), direction(0), noise(1)
+    {
+    }
+
+    void moveLeft() override { direction = -1; }
+    void moveRight() override { direction = 1; }
+    void stop() override { direction = 0; }
+
+    void step(double seconds)
+    {
+        position += direction * speed * seconds;
+    }
+
+protected:
+    void setupPins() override {}
+
+    int readPoti() override
+    {
+        // +-2 counts of ADC noise
+        noise = noise * 1103515245 + 12345;
+        return (int)lround(position * 4) + (int)((noise >> 16) % 5) - 2;
+    }
+};
+
+struct Pass
+{
+    double maxElevation;
+    double crossTrack; // Central angle between observer and ground track, radians
+    double halfTime;   // s from AOS to the closest approach
+};
+
+struct Position
+{
+    double azimuth;
+    double elevation;
+};
+
+// Ground track south of the observer, heading east. Earth rotation is
+// ignored, it does not change the shape of a single pass much.
+static Position passPosition(const Pass &pass, double seconds)
+{
+    double theta = 2 * M_PI * (seconds - pass.halfTime) / ORBIT_PERIOD;
+    double radius = EARTH_RADIUS + ORBIT_ALTITUDE;
+    double north = -radius * cos(theta) * sin(pass.crossTrack);
+    double east = radius * sin(theta);
+    double up = radius * cos(theta) * cos(pass.crossTrack) - EARTH_RADIUS;
+
+    Position position;
+    position.azimuth = atan2(east, north) * degreesPerRadian;
+    if (position.azimuth < 0)
+    {
+        position.azimuth += 360;
+    }
+    position.elevation = atan2(up, sqrt(north * north + east * east)) * degreesPerRadian;
+    return position;
+}
+
+static Pass makePass(double maxElevation)
+{
+    Pass pass;
+    double low = 0;
+    double high = acos(EARTH_RADIUS / (EARTH_RADIUS + ORBIT_ALTITUDE));
+
+    pass.maxElevation = maxElevation;
+    pass.halfTime = 0;
+    for (int i = 0; i < 60; i++)
+    {
+        pass.crossTrack = (low + high) / 2;
+        if (passPosition(pass, 0).elevation > maxElevation)
+        {
+            low = pass.crossTrack;
+        }
+        else
+        {
+            high = pass.crossTrack;
+        }
+    }
+
+    double horizon = acos(EARTH_RADIUS / (EARTH_RADIUS + ORBIT_ALTITUDE) / cos(pass.crossTrack));
+    pass.halfTime = horizon / (2 * M_PI) * ORBIT_PERIOD;
+    return pass;
+}
+
+struct AxisError
+{
+    double sum = 0;
+    double squares = 0;
+    double max = 0;
+    long count = 0;
+
+    void add(double error)
+    {
+        sum += error;
+        squares += error * error;
+        max = std::max(max, fabs(error));
+        count++;
+    }
+
+    double mean() const { return count > 0 ? sum / count : 0; }
+    double rms() const { return count > 0 ? sqrt(squares / count) : 0; }
+};
+
+struct Result
+{
+    AxisError azimuth;
+    AxisError elevation;
+    uint32_t rejected;
+    // After the end of the stream: largest distance from the last setpoint
+    // and lowest elevation
+    double azimuthOverrun = 0;
+    double elevationOverrun = 0;
+    double elevationLowest = 90;
+};
+
+struct Options
+{
+    unsigned long updateInterval = 1000;
+    unsigned long tick = 10;
+    int numReadings = 64;
+    int potiTolerance = 2;
+    unsigned long jitter = 50;
+};
+
+// Calibrated limits as findMin()/findMax() leave them, all 0 if uncalibrated
+struct Limits
+{
+    angle_t azimuthMin;
+    angle_t azimuthMax;
+    angle_t elevationMin;
+    angle_t elevationMax;
+};
+
+static angle_t toAngle(double degrees)
+{
+    return (angle_t)lround(degrees * ANGLE_SCALE);
+}
+
+// Same order as updatePosition() in main.cpp: extrapolated targets first,
+// then the filter update and motor decision
+static Result run(const Options &options, const std::vector<Pass> &passes, const Limits &limits, bool feedForward, bool endMidPass)
+{
+    Position start = passPosition(passes[0], 0);
+    SimulatedRotor azimuth(start.azimuth, 6.2, options.potiTolerance, options.numReadings);
+    SimulatedRotor elevation(0, 2.7, options.potiTolerance, options.numReadings);
+    SetpointTracker azimuthTracker;
+    SetpointTracker elevationTracker;
+    unsigned long latency = trackingLatency(options.tick * 1000, options.numReadings);
+    uint32_t jitter = 7;
+    Result result;
+
+    azimuth.initialize();
+    elevation.initialize();
+    azimuth.setMin(limits.azimuthMin);
+    azimuth.setMax(limits.azimuthMax);
+    elevation.setMin(limits.elevationMin);
+    elevation.setMax(limits.elevationMax);
+
+    unsigned long now = 0;
+
+    // Same windows as applyFeedForward() in main.cpp
+    auto controlTick = [&]()
+    {
+        angle_t lower;
+        angle_t upper;
+
+        if (feedForward && azimuthTracker.isTracking())
+        {
+            trackingLimits(azimuth.getMin(), azimuth.getMax(), ANGLE_DEGREES(-360), ANGLE_DEGREES(360), lower, upper);
+            azimuth.setTarget(azimuthTracker.predict(now, latency, lower, upper));
+        }
+        if (feedForward && elevationTracker.isTracking())
+        {
+            trackingLimits(elevation.getMin(), elevation.getMax(), 0, ANGLE_DEGREES(90), lower, upper);
+            elevation.setTarget(elevationTracker.predict(now, latency, lower, upper));
+        }
+        azimuth.updatePosition();
+        elevation.updatePosition();
+        azimuth.step(options.tick / 1000.0);
+        elevation.step(options.tick / 1000.0);
+    };
+
+    Position last = {0, 0};
+    for (const Pass &pass : passes)
+    {
+        unsigned long aos = now + PARK_TIME;
+        unsigned long los = aos + (unsigned long)(2 * pass.halfTime * 1000);
+        if (endMidPass && &pass == &passes.back())
+        {
+            // Closest approach, where the satellite moves fastest
+            los = aos + (unsigned long)(pass.halfTime * 1000);
+        }
+        unsigned long nextSetpoint = now;
+
+        for (; now < los; now += options.tick)
+        {
+            if (now >= nextSetpoint)
+            {
+                Position setpoint = passPosition(pass, now < aos ? 0 : (now - aos) / 1000.0);
+                setpoint.elevation = std::max(setpoint.elevation, 0.0);
+                last = setpoint;
+                azimuthTracker.addSetpoint(toAngle(setpoint.azimuth), now);
+                elevationTracker.addSetpoint(toAngle(setpoint.elevation), now);
+                azimuth.setTarget(toAngle(setpoint.azimuth));
+                elevation.setTarget(toAngle(setpoint.elevation));
+
+                jitter = jitter * 1103515245 + 12345;
+                nextSetpoint += options.updateInterval;
+                nextSetpoint += options.jitter > 0 ? (jitter >> 16) % options.jitter : 0;
+            }
+
+            controlTick();
+
+            if (now >= aos)
+            {
+                Position actual = passPosition(pass, (now + options.tick - aos) / 1000.0);
+                result.azimuth.add(azimuth.position - actual.azimuth);
+                result.elevation.add(elevation.position - std::max(actual.elevation, 0.0));
+            }
+        }
+    }
+
+    for (unsigned long end = now + END_TIME; now < end; now += options.tick)
+    {
+        controlTick();
+        result.azimuthOverrun = std::max(result.azimuthOverrun, fabs(azimuth.position - last.azimuth));
+        result.elevationOverrun = std::max(result.elevationOverrun, fabs(elevation.position - last.elevation));
+        result.elevationLowest = std::min(result.elevationLowest, elevation.position);
+    }
+
+    result.rejected = azimuthTracker.getRejected() + elevationTracker.getRejected();
+    return result;
+}
+
+static void printResult(const char *name, const Result &result)
+{
+    printf("  %-16s %8.2f %8.2f %8.2f %10.2f %8.2f %8.2f %10u\n", name,
+           result.azimuth.mean(), result.azimuth.rms(), result.azimuth.max,
+           result.elevation.mean(), result.elevation.rms(), result.elevation.max,
+           result.rejected);
+}
+
+static void printEndOfStream(const char *name, const Result &result)
+{
+    printf("  %-28s %12.2f %12.2f %12.2f\n", name, result.azimuthOverrun, result.elevationOverrun, result.elevationLowest);
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "u:i:n:t:j:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'u':
+            options.updateInterval = strtoul(optarg, nullptr, 10);
+            break;
+        case 'i':
+            options.tick = strtoul(optarg, nullptr, 10);
+            break;
+        case 'n':
+            options.numReadings = atoi(optarg);
+            break;
+        case 't':
+            options.potiTolerance = atoi(optarg);
+            break;
+        case 'j':
+            options.jitter = strtoul(optarg, nullptr, 10);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-u update-ms] [-i tick-ms] [-n readings] [-t tolerance] [-j jitter-ms]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (options.updateInterval < 1 || options.tick < 1 || options.numReadings < 1)
+    {
+        fprintf(stderr, "update interval, tick and readings must be positive\n");
+        return 2;
+    }
+
+    std::vector<Pass> passes = {makePass(72), makePass(35)};
+    Limits uncalibrated = {0, 0, 0, 0};
+    Limits calibrated = {ANGLE_DEGREES(20), ANGLE_DEGREES(340), ANGLE_DEGREES(5), ANGLE_DEGREES(85)};
+
+    printf("2 LEO passes at %.0f km (max elevation %.0f and %.0f deg), setpoints every %lu ms +%lu ms jitter\n",
+           ORBIT_ALTITUDE, passes[0].maxElevation, passes[1].maxElevation, options.updateInterval, options.jitter);
+    printf("control tick %lu ms, %d readings, tolerance %d, compensated latency %lu ms\n",
+           options.tick, options.numReadings, options.potiTolerance,
+           trackingLatency(options.tick * 1000, options.numReadings));
+    printf("  %-16s %8s %8s %8s %10s %8s %8s %10s\n", "error in deg", "az mean", "az rms", "az max",
+           "el mean", "el rms", "el max", "rejected");
+    Result off = run(options, passes, uncalibrated, false, false);
+    Result on = run(options, passes, uncalibrated, true, false);
+    Result onCalibrated = run(options, passes, calibrated, true, false);
+    printResult("feed-forward off", off);
+    printResult("feed-forward on", on);
+    printResult("on, calibrated", onCalibrated);
+
+    printf("end of stream, %d s after the last setpoint\n", END_TIME / 1000);
+    printf("  %-28s %12s %12s %12s\n", "error in deg", "az overrun", "el overrun", "lowest el");
+    printEndOfStream("at LOS, feed-forward off", off);
+    printEndOfStream("at LOS, feed-forward on", on);
+    printEndOfStream("at LOS, on, calibrated", onCalibrated);
+    printEndOfStream("mid-pass, feed-forward off", run(options, passes, uncalibrated, false, true));
+    printEndOfStream("mid-pass, feed-forward on", run(options, passes, uncalibrated, true, true));
+    printEndOfStream("mid-pass, on, calibrated", run(options, passes, calibrated, true, true));
+    return 0;
+}